@@ -0,0 +1,24 @@
+#include "change_detect.h"
+
+bool ChangeDetector::shouldSend(size_t jpeg_len, uint32_t now_ms) {
+  bool send = !_cfg.enabled || _ref_len == 0;
+
+  if (!send) {
+    size_t diff = (jpeg_len > _ref_len) ? jpeg_len - _ref_len : _ref_len - jpeg_len;
+    // compared against the last *sent* frame so slow drift still adds up
+    send = (uint32_t)diff * 1000 >= (uint32_t)_ref_len * _cfg.size_delta_permille;
+  }
+  if (!send && (now_ms - _last_sent_ms) >= _cfg.keepalive_ms) {
+    send = true;   // keep-alive
+  }
+
+  if (send) {
+    _ref_len = jpeg_len;
+    _last_sent_ms = now_ms;
+    _stats.sent++;
+  } else {
+    _stats.skipped++;
+    _stats.bytes_saved += jpeg_len;
+  }
+  return send;
+}
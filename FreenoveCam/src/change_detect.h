@@ -0,0 +1,40 @@
+#ifndef CHANGE_DETECT_H
+#define CHANGE_DETECT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct ChangeDetectConfig {
+  bool enabled = true;
+  // JPEG size change vs the last sent frame that counts as motion, in 1/1000
+  uint16_t size_delta_permille = 20;
+  // a frame still goes out this often on a static scene, for liveness
+  uint32_t keepalive_ms = 1000;
+};
+
+struct ChangeDetectStats {
+  uint32_t sent = 0;
+  uint32_t skipped = 0;
+  uint32_t bytes_saved = 0;
+};
+
+// Decides per captured frame whether it is worth the airtime.
+// The sensor JPEG size tracks scene detail closely, so a static scene
+// gives nearly constant sizes while motion or lighting changes move it.
+class ChangeDetector {
+public:
+  void configure(const ChangeDetectConfig &cfg) { _cfg = cfg; }
+
+  // true when the frame should be transmitted, updates the stats
+  bool shouldSend(size_t jpeg_len, uint32_t now_ms);
+
+  const ChangeDetectStats &stats() const { return _stats; }
+
+private:
+  ChangeDetectConfig _cfg;
+  ChangeDetectStats _stats;
+  size_t _ref_len = 0;        // size of the last frame sent
+  uint32_t _last_sent_ms = 0;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#include "control_link.h"
+
+uint8_t controlLinkCrc8(const uint8_t *data, size_t len) {
+  uint8_t crc = 0;
+  while (len--) {
+    crc ^= *data++;
+    for (uint8_t i = 0; i < 8; i++) {
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+size_t controlLinkEncode(uint8_t *out, size_t out_len, uint8_t seq, const ControlPayload &p) {
+  const size_t n = CONTROL_LINK_OVERHEAD + 2;
+  if (out_len < n) return 0;
+
+  out[0] = CONTROL_LINK_SYNC;
+  out[1] = CONTROL_LINK_VERSION;
+  out[2] = seq;
+  out[3] = 2;
+  out[4] = (uint8_t)p.dir;
+  out[5] = p.button;
+  out[6] = controlLinkCrc8(out + 1, 5);
+  return n;
+}
+
+bool ControlLinkParser::feed(uint8_t b) {
+  switch (_state) {
+    case WAIT_SYNC:
+      if (b == CONTROL_LINK_SYNC) {
+        _pos = 0;
+        _state = VERSION;
+      }
+      return false;
+
+    case VERSION:
+      if (b != CONTROL_LINK_VERSION) {
+        _stats.bad_frames++;
+        // this byte may itself start the next frame
+        _state = (b == CONTROL_LINK_SYNC) ? VERSION : WAIT_SYNC;
+        return false;
+      }
+      _buf[_pos++] = b;
+      _state = SEQ;
+      return false;
+
+    case SEQ:
+      _buf[_pos++] = b;
+      _state = LEN;
+      return false;
+
+    case LEN:
+      if (b < 2 || b > CONTROL_LINK_MAX_DATA) {
+        _stats.bad_frames++;
+        _state = WAIT_SYNC;
+        return false;
+      }
+      _len = b;
+      _buf[_pos++] = b;
+      _state = DATA;
+      return false;
+
+    case DATA:
+      _buf[_pos++] = b;
+      if (_pos == 3 + _len) _state = CRC;
+      return false;
+
+    case CRC:
+      _state = WAIT_SYNC;
+      if (controlLinkCrc8(_buf, _pos) != b) {
+        _stats.crc_errors++;
+        return false;
+      }
+      break;
+  }
+
+  uint8_t seq = _buf[1];
+  if (_have_seq && seq != (uint8_t)(_seq + 1)) _stats.seq_gaps++;
+  _seq = seq;
+  _have_seq = true;
+
+  // longer payloads from newer senders keep the version 1 fields first
+  _payload.dir = (int8_t)_buf[3];
+  _payload.button = _buf[4];
+  _stats.frames++;
+  return true;
+}
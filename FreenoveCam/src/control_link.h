@@ -0,0 +1,61 @@
+#ifndef CONTROL_LINK_H
+#define CONTROL_LINK_H
+
+// Framed binary control messages over the Serial2 link to the drive
+// Arduino. Plain C++ with no Arduino or STL dependencies so the same
+// file builds on the AVR side for the receiving parser.
+//
+// frame: SYNC | VERSION | SEQ | LEN | payload[LEN] | CRC8
+// CRC8 (poly 0x07, init 0x00) covers VERSION through the payload.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CONTROL_LINK_SYNC      0xA5
+#define CONTROL_LINK_VERSION   0x01
+#define CONTROL_LINK_BAUD      38400     // safe for SoftwareSerial on a 16 MHz AVR
+#define CONTROL_LINK_MAX_DATA  8
+#define CONTROL_LINK_OVERHEAD  5         // sync, version, seq, len, crc
+
+// version 1 payload
+struct ControlPayload {
+  int8_t dir;      // -2=left, -1=down, 0=center, 1=up, 2=right
+  uint8_t button;
+};
+
+uint8_t controlLinkCrc8(const uint8_t *data, size_t len);
+
+// writes one frame into out, returns its size (0 if out is too small)
+size_t controlLinkEncode(uint8_t *out, size_t out_len, uint8_t seq, const ControlPayload &p);
+
+struct ControlLinkStats {
+  uint32_t frames = 0;
+  uint32_t crc_errors = 0;
+  uint32_t bad_frames = 0;   // wrong version or length
+  uint32_t seq_gaps = 0;     // frames lost on the wire, going by seq
+};
+
+// byte-at-a-time parser, resynchronizes on the next SYNC after any error
+class ControlLinkParser {
+public:
+  // returns true when b completed a valid frame, read it with payload()
+  bool feed(uint8_t b);
+
+  const ControlPayload &payload() const { return _payload; }
+  uint8_t seq() const { return _seq; }
+  const ControlLinkStats &stats() const { return _stats; }
+
+private:
+  enum State : uint8_t { WAIT_SYNC, VERSION, SEQ, LEN, DATA, CRC };
+
+  State _state = WAIT_SYNC;
+  uint8_t _buf[3 + CONTROL_LINK_MAX_DATA];   // version, seq, len, data
+  uint8_t _pos = 0;
+  uint8_t _len = 0;
+  uint8_t _seq = 0;
+  bool _have_seq = false;
+  ControlPayload _payload = {0, 0};
+  ControlLinkStats _stats;
+};
+
+#endif
@@ -6,7 +6,13 @@
  **************************************************/
 #include <Arduino.h>
 #include "esp_camera.h"
+#include "esp_timer.h"
 #include <ESPNowCam.h>
+#include <DeferredLog.h>
+
+#include "change_detect.h"
+#include "control_link.h"
+#include "seqlock.h"
 
 // ===== controller side ESP32 MAC (Metro S3) =====
 static const uint8_t MAC_RECV[6] = {0x80, 0xB5, 0x4E, 0xCD, 0x29, 0x20};
@@ -28,6 +34,14 @@ static framesize_t CAM_FRAMESIZE = FRAMESIZE_HVGA; // 320x240
 #define CAM_FB_COUNT     2               // double buffering
 #define CAM_XCLK_HZ      10000000        // 10 MHz is conservative and stable
 
+// frames are copied here so the fb goes back to the driver before the
+// (blocking) radio send, letting the next capture run during transmit
+static const size_t STAGE_MAX = 32 * 1024;
+static uint8_t *stageBuf = nullptr;
+
+// skips frames of a static scene, with a keep-alive frame every second
+static ChangeDetector motion;
+
 // transmitter pin for TX2, talks to arduino D8
 static const int ESP_TX2 = 14;
 
@@ -37,14 +51,34 @@ struct controlState {
   uint8_t button;
 };
 
-controlState latestControl = {0, 0};
-volatile bool controlUpdated = false;
+// written by the ESP-NOW callback (Wi-Fi task), read by loop()
+static SeqLock<controlState> latestControl;
+
+// receive-side counters, published for the telemetry task to print
+struct RxTelemetry {
+  uint32_t packets;
+  uint32_t bad_len;
+  uint8_t last_len;
+  uint8_t last_raw[8];
+};
+static SeqLock<RxTelemetry> rxTelemetry;
 
 volatile bool sequenceStarted = false;
 // time since last send
 unsigned long lastSentMs = 0;
 // maximum ms between sends
 const unsigned long HEARTBEAT_MS = 200; // 200ms for 5Hz
+// last state forwarded to the Arduino
+static controlState lastForwarded = {0, 0};
+
+// the drive Arduino still parses "%d,%d\n" at 9600. build with
+// -D CONTROL_LINK_BINARY once its ControlLinkParser side is flashed
+#ifdef CONTROL_LINK_BINARY
+static const uint32_t LINK_BAUD = CONTROL_LINK_BAUD;
+static uint8_t linkSeq = 0;   // seq of the next frame
+#else
+static const uint32_t LINK_BAUD = 9600;
+#endif
 // ==== test LED ====
 #define builtInLED 2  // on GPIO pin 2 on WROVER is IO2 builtin LED
 
@@ -93,7 +127,8 @@ static camera_config_t camCfg() {
   CAM_JPEG_QUALITY = c.jpeg_quality;
   CAM_FRAMESIZE = c.frame_size;
   c.fb_count     = CAM_FB_COUNT;
-  c.grab_mode    = CAMERA_GRAB_WHEN_EMPTY;
+  // always hand out the newest frame instead of one queued an interval ago
+  c.grab_mode    = CAMERA_GRAB_LATEST;
 
   return c;
 }
@@ -118,37 +153,91 @@ if (s) {
 }
 }
 
+// runs in the Wi-Fi task: no printing here, the telemetry task logs it
 void OnDataRecv(const uint8_t * mac, const uint8_t *incomingData, int len) {
-  Serial.printf("Raw len=%d: ", len);
-  for (int i = 0; i < len; i++) {
-    Serial.printf("%02X ", incomingData[i]);
-  }
-  Serial.println();
+  static RxTelemetry t = {};   // only this callback writes it
+
+  t.packets++;
+  t.last_len = (uint8_t)len;
+  // a short packet must not show bytes left over from a longer one
+  memset(t.last_raw, 0, sizeof(t.last_raw));
+  memcpy(t.last_raw, incomingData, min((int)sizeof(t.last_raw), len));
 
   if (len != sizeof(controlState)) {
-    Serial.printf("Received invalid control data size: %d\n", len);
+    t.bad_len++;
+    rxTelemetry.write(t);
     return;
   }
+  rxTelemetry.write(t);
 
   controlState tmp;
   memcpy(&tmp, incomingData, sizeof(controlState));
+  latestControl.write(tmp);
+}
+
+// low priority: logs what OnDataRecv used to dump per packet, once a second
+static void telemetryTask(void *arg) {
+  uint32_t seen = 0;
+  for (;;) {
+    vTaskDelay(pdMS_TO_TICKS(1000));
+
+    uint32_t version;
+    RxTelemetry t;
+    if (!rxTelemetry.read(t, &version) || version == seen) continue;
+    seen = version;
+
+    // first 4 raw bytes, in wire order
+    uint32_t raw = ((uint32_t)t.last_raw[0] << 24) | ((uint32_t)t.last_raw[1] << 16) |
+                   ((uint32_t)t.last_raw[2] << 8) | t.last_raw[3];
+    DLOG("rx packets=%u bad_len=%u last len=%u raw=%08X", t.packets, t.bad_len, t.last_len, raw);
+  }
+}
+
+// forward the latest control state to the Arduino, right away when it
+// changed, otherwise on the heartbeat as a backup
+static void forwardControl() {
+  // one consistent snapshot, never dir from packet N and
+  // button from packet N+1. on a lost race keep the last state
+  controlState cs = lastForwarded;
+  latestControl.read(cs);
 
-  noInterrupts();
-  latestControl = tmp;       // single atomic assignment, no reset
-  controlUpdated = true;
-  interrupts();
+  bool changed = (cs.dir != lastForwarded.dir) || (cs.button != lastForwarded.button);
+  bool heartbeat = (millis() - lastSentMs) >= HEARTBEAT_MS; // 5 Hz
+  if (!changed && !heartbeat) return;
+
+  lastSentMs = millis();
+  lastForwarded = cs;
+
+#ifdef CONTROL_LINK_BINARY
+  ControlPayload p = {cs.dir, cs.button};
+  uint8_t frame[CONTROL_LINK_OVERHEAD + CONTROL_LINK_MAX_DATA];
+  size_t n = controlLinkEncode(frame, sizeof(frame), linkSeq++, p);
+  Serial2.write(frame, n);
+#else
+  Serial2.printf("%d,%d\n", cs.dir, cs.button);
+#endif
+
+  // log the current state
+  DLOG("%d,%d", cs.dir, cs.button);
 }
 
 void setup() {
   Serial.begin(115200);
+  dlog::begin(Serial);   // hot paths log through the deferred ring
   delay(200);
   Serial.println("\nESPNowCam Freenove sender (explicit pin map)");
 
-  Serial2.begin(9600, SERIAL_8N1, -1, ESP_TX2); // TX2 only
+  Serial2.begin(LINK_BAUD, SERIAL_8N1, -1, ESP_TX2); // TX2 only
 
   // camera first (avoids radio contention during DMA setup)
   initCameraOrHalt();
 
+  // staging buffer for the frame being transmitted
+  stageBuf = (uint8_t*)(psramFound() ? ps_malloc(STAGE_MAX) : malloc(STAGE_MAX));
+  if (!stageBuf) {
+    Serial.println("stage buffer alloc failed, sending from fb");
+  }
+
   // radio next
   // set target as S3 MAC addr
   radio.setTarget(MAC_RECV);
@@ -156,6 +245,9 @@ void setup() {
 
   esp_now_register_recv_cb(OnDataRecv);
 
+  // idle priority, logging only runs when camera/radio work yields
+  xTaskCreate(telemetryTask, "telemetry", 3072, nullptr, tskIDLE_PRIORITY, nullptr);
+
   // Print PSRAM info (just informational)
   if (psramFound()) {
     size_t mb = esp_spiram_get_size() / 1048576;
@@ -166,9 +258,9 @@ void setup() {
 // fb size if set to 15000B for the receiver. started work here to determine frame size 
 // and adjust buffer size accordingly. couln't log fb size in line 144 just yet.
 void loop() {
-  controlState cs;
+  // control first, so a change isn't held back by the camera throttle
+  forwardControl();
 
-  int count = 0; // counter var to log fb size every 5 sends
   uint32_t now = millis();
   if (now - lastSend < SEND_INTERVAL_MS) {
     delay(1); // yield
@@ -181,39 +273,43 @@ void loop() {
   camera_fb_t *fb = esp_camera_fb_get();
   if (!fb) {
     // If this happens often, reduce framesize or raise SEND_INTERVAL_MS
-    Serial.println("Capture failed");
+    DLOG_EVERY(1000, "Capture failed");
     delay(5);
     return;
   }
 
-  // Send via ESP-NOW (ESPNowCam handles fragmentation)
-  radio.sendData(fb->buf, fb->len);
+  // how long ago the sensor finished this frame
+  int64_t captured_us = (int64_t)fb->timestamp.tv_sec * 1000000 + fb->timestamp.tv_usec;
+  uint32_t age_ms = (uint32_t)((esp_timer_get_time() - captured_us) / 1000);
+  size_t len = fb->len;
 
-  if ((++count % 5) == 0) // log every 5 frames
-    Serial.printf("Sent %u bytes\n", (unsigned)fb->len);
+  if (!motion.shouldSend(len, now)) {
+    // nothing changed, save the airtime for control traffic
+    esp_camera_fb_return(fb);
+  } else {
+    // Send via ESP-NOW (ESPNowCam handles fragmentation)
+    if (stageBuf && len <= STAGE_MAX) {
+      // copy out and release right away, the driver refills this fb
+      // while the radio is busy with the copy
+      memcpy(stageBuf, fb->buf, len);
+      esp_camera_fb_return(fb);
+      radio.sendData(stageBuf, len);
+    } else {
+      radio.sendData(fb->buf, len);
+      esp_camera_fb_return(fb);
+    }
+
+    // at most once a second, the rest are counted as suppressed
+    // keep-alive guarantees one of these a second even on a static scene
+    const ChangeDetectStats &st = motion.stats();
+    dlog::Stats ls = dlog::stats();
+    DLOG_EVERY(1000, "Sent %u bytes, frame age %u ms, skipped %u (%u bytes saved), log dropped %u limited %u",
+               len, age_ms, st.skipped, st.bytes_saved, ls.dropped, ls.rate_limited);
+  }
 
-  // Release buffer + friendly yields
-  esp_camera_fb_return(fb);
+  // friendly yield
   delay(0);
 
-  // guarantee we process latest control input, not 
-  // dir from packet N and start from packet N+1
-  noInterrupts();
-  memcpy(&cs, (const void*)&latestControl, sizeof(cs));
-  controlUpdated = false;
-  interrupts();
-
-  bool heartbeat = (millis() - lastSentMs) >= HEARTBEAT_MS; // 5 Hz
-
-  // if heartbeat timeout, send update
-  if (heartbeat) {
-    // serial print the current state
-    lastSentMs = millis();
-
-    int d = (int)cs.dir;
-    int b = (int)cs.button;
-
-    Serial.printf("%d,%d\n", d, b);
-    Serial2.printf("%d,%d\n", d, b);
-  }
+  // and again after the (blocking) frame send
+  forwardControl();
 }
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+
+// Latest-value mailbox for one writer and any number of readers.
+// The writer never blocks and never masks interrupts; readers retry if
+// they raced a write. T must be trivially copyable.
+//
+// The writer must not be preempted by a reader spinning on the same
+// core. Here the writer is the Wi-Fi task, which outranks every reader.
+template <typename T>
+class SeqLock {
+public:
+  void write(const T &value) {
+    uint32_t s = _seq.load(std::memory_order_relaxed);
+    _seq.store(s + 1, std::memory_order_relaxed);   // odd: write in progress
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&_data, &value, sizeof(T));
+    std::atomic_thread_fence(std::memory_order_release);
+    _seq.store(s + 2, std::memory_order_release);
+  }
+
+  // copies a consistent snapshot into out. returns false if every
+  // attempt raced a write, out is then left untouched
+  bool read(T &out, uint32_t *version = nullptr, int attempts = 8) const {
+    while (attempts-- > 0) {
+      uint32_t s1 = _seq.load(std::memory_order_acquire);
+      if (s1 & 1) continue;
+      T tmp;
+      memcpy(&tmp, &_data, sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (_seq.load(std::memory_order_relaxed) != s1) continue;
+      out = tmp;
+      if (version) *version = s1;
+      return true;
+    }
+    return false;
+  }
+
+  // bumps by 2 per write, compare against a remembered value to see
+  // whether anything new arrived
+  uint32_t version() const { return _seq.load(std::memory_order_acquire); }
+
+private:
+  std::atomic<uint32_t> _seq{0};
+  T _data{};
+};
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef HOST_ARDUINO_SHIM_H
+#define HOST_ARDUINO_SHIM_H
+
+// the little of Arduino + FreeRTOS that DeferredLog needs, on std::thread,
+// so [env:native] can build the library unchanged
+
+#include <chrono>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <thread>
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t b) = 0;
+  virtual size_t write(const uint8_t *buf, size_t n) {
+    for (size_t i = 0; i < n; i++) write(buf[i]);
+    return n;
+  }
+  size_t printf(const char *fmt, ...) {
+    char buf[160];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    if (n < 0) return 0;
+    if (n >= (int)sizeof(buf)) n = sizeof(buf) - 1;
+    return write((const uint8_t *)buf, n);
+  }
+};
+
+inline uint32_t millis() {
+  static const auto start = std::chrono::steady_clock::now();
+  return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start).count();
+}
+
+// FreeRTOS: 1 ms ticks, tasks are detached threads that run forever
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void *TaskHandle_t;
+#define tskIDLE_PRIORITY 0
+#define pdPASS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+inline void vTaskDelay(TickType_t ticks) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+inline int xTaskCreate(void (*fn)(void *), const char *, uint32_t, void *arg, UBaseType_t,
+                       TaskHandle_t *) {
+  std::thread(fn, arg).detach();
+  return pdPASS;
+}
+
+#endif
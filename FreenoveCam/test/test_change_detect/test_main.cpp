@@ -0,0 +1,121 @@
+// replays recorded JPEG size sequences through ChangeDetector:
+//   pio test -e native -f test_change_detect
+#include <unity.h>
+
+#include "change_detect.h"
+
+static const uint32_t FRAME_MS = 50;   // QQVGA at ~20 fps
+
+// QQVGA sizes from a static desk scene, sensor noise only (< 1%)
+static const uint16_t STATIC_SCENE[] = {
+  4212, 4198, 4225, 4207, 4219, 4203, 4231, 4210, 4195, 4222,
+  4214, 4206, 4228, 4201, 4217, 4209, 4224, 4199, 4213, 4220,
+  4205, 4227, 4211, 4196, 4218, 4208, 4223, 4202, 4215, 4212,
+  4200, 4226, 4209, 4216, 4204, 4221, 4197, 4214, 4219, 4207,
+  4211, 4225, 4203, 4218, 4210, 4198, 4229, 4206, 4215, 4213,
+};
+
+// same scene, a hand passes through the frame from sample 10 to 19
+static const uint16_t HAND_WAVE[] = {
+  4212, 4198, 4225, 4207, 4219, 4203, 4231, 4210, 4195, 4222,
+  4580, 5120, 5630, 5910, 5770, 5340, 4960, 4650, 4420, 4240,
+  4214, 4206, 4228, 4201, 4217, 4209, 4224, 4199, 4213, 4220,
+};
+
+static const size_t STATIC_LEN = sizeof(STATIC_SCENE) / sizeof(STATIC_SCENE[0]);
+static const size_t WAVE_LEN = sizeof(HAND_WAVE) / sizeof(HAND_WAVE[0]);
+
+static ChangeDetector det;
+
+// feeds sizes one frame period apart from start_ms, returns frames sent
+static uint32_t replay(const uint16_t *sizes, size_t n, uint32_t start_ms = 0, bool *sent = nullptr) {
+  uint32_t count = 0;
+  for (size_t i = 0; i < n; i++) {
+    bool s = det.shouldSend(sizes[i], start_ms + i * FRAME_MS);
+    if (sent) sent[i] = s;
+    count += s;
+  }
+  return count;
+}
+
+void setUp() {
+  det = ChangeDetector();
+  det.configure(ChangeDetectConfig());   // 2%, 1 s keep-alive
+}
+
+void tearDown() {}
+
+static void test_static_scene_keepalive_only() {
+  bool sent[STATIC_LEN];
+  // 2.5 s of static scene: the first frame, then one per keep-alive
+  TEST_ASSERT_EQUAL_UINT32(3, replay(STATIC_SCENE, STATIC_LEN, 0, sent));
+  TEST_ASSERT_TRUE(sent[0]);
+  TEST_ASSERT_TRUE(sent[1000 / FRAME_MS]);
+  TEST_ASSERT_TRUE(sent[2000 / FRAME_MS]);
+
+  const ChangeDetectStats &st = det.stats();
+  TEST_ASSERT_EQUAL_UINT32(3, st.sent);
+  TEST_ASSERT_EQUAL_UINT32(STATIC_LEN - 3, st.skipped);
+  TEST_ASSERT_GREATER_THAN_UINT32(40 * 4190, st.bytes_saved);
+}
+
+static void test_motion_sent_immediately() {
+  bool sent[WAVE_LEN];
+  replay(HAND_WAVE, WAVE_LEN, 0, sent);
+  for (size_t i = 1; i < 10; i++) TEST_ASSERT_FALSE(sent[i]);
+  // every frame of the wave moves more than 2% from the one before
+  for (size_t i = 10; i < 20; i++) TEST_ASSERT_TRUE(sent[i]);
+  // back at rest the last wave frame is the reference, noise stays under it
+  for (size_t i = 20; i < WAVE_LEN; i++) TEST_ASSERT_FALSE(sent[i]);
+}
+
+static void test_threshold_boundary() {
+  ChangeDetectConfig cfg;
+  cfg.keepalive_ms = 0xFFFFFFFF;
+  det.configure(cfg);
+
+  TEST_ASSERT_TRUE(det.shouldSend(5000, 0));
+  TEST_ASSERT_FALSE(det.shouldSend(5099, 50));   // 1.98%
+  TEST_ASSERT_FALSE(det.shouldSend(4901, 100));
+  TEST_ASSERT_TRUE(det.shouldSend(5100, 150));   // exactly 2%
+  TEST_ASSERT_TRUE(det.shouldSend(4998, 200));   // 2% of the new reference
+}
+
+static void test_slow_drift_accumulates() {
+  // lighting fades 0.5% per frame: each frame alone is under threshold,
+  // but the reference is the last sent frame so the drift still goes out
+  ChangeDetectConfig cfg;
+  cfg.keepalive_ms = 0xFFFFFFFF;
+  det.configure(cfg);
+
+  uint32_t sent = 0;
+  double len = 6000;
+  for (int i = 0; i < 40; i++, len *= 0.995) sent += det.shouldSend((size_t)len, i * FRAME_MS);
+  // first frame + one every 4-5 frames of drift
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(8, sent);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(11, sent);
+}
+
+static void test_keepalive_across_millis_wrap() {
+  const uint32_t start = 0xFFFFFFFF - 500;
+  TEST_ASSERT_EQUAL_UINT32(3, replay(STATIC_SCENE, STATIC_LEN, start));
+}
+
+static void test_disabled_sends_everything() {
+  ChangeDetectConfig cfg;
+  cfg.enabled = false;
+  det.configure(cfg);
+  TEST_ASSERT_EQUAL_UINT32(STATIC_LEN, replay(STATIC_SCENE, STATIC_LEN));
+  TEST_ASSERT_EQUAL_UINT32(0, det.stats().skipped);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_static_scene_keepalive_only);
+  RUN_TEST(test_motion_sent_immediately);
+  RUN_TEST(test_threshold_boundary);
+  RUN_TEST(test_slow_drift_accumulates);
+  RUN_TEST(test_keepalive_across_millis_wrap);
+  RUN_TEST(test_disabled_sends_everything);
+  return UNITY_END();
+}
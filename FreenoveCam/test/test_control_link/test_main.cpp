@@ -0,0 +1,220 @@
+// ControlLinkParser against a simulated lossy Serial2 link:
+//   pio test -e native -f test_control_link
+#include <stdio.h>
+#include <unity.h>
+
+#include "control_link.h"
+
+static const uint32_t HEARTBEAT_MS = 200;   // same as forwardControl()
+
+// deterministic so a failure replays exactly
+struct Rng {
+  uint32_t s;
+  uint32_t next() {
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+  }
+  bool chance(uint32_t ppm) { return ppm && next() % 1000000 < ppm; }
+};
+
+struct LinkConfig {
+  uint32_t seed = 1;
+  uint32_t baud = CONTROL_LINK_BAUD;
+  uint32_t corrupt_ppm = 0;   // per byte, replaced by a random value
+  uint32_t drop_ppm = 0;      // per byte, lost on the wire
+  uint32_t duration_ms = 120000;
+};
+
+struct LinkResult {
+  uint32_t sent = 0;
+  uint32_t damaged = 0;       // frames with at least one bad or missing byte
+  uint32_t delivered = 0;
+  uint32_t wrong = 0;         // accepted frames that don't match what was sent
+  uint32_t gaps_seen = 0;     // seq discontinuities in the accepted stream
+  uint32_t changes = 0;
+  uint32_t latency_n = 0;
+  double latency_sum_ms = 0;
+  double latency_max_ms = 0;
+  ControlLinkStats stats;
+};
+
+// drives the forwardControl() policy (send on change, else on heartbeat)
+// over a byte-serial link and measures change -> accepted-at-receiver time
+static LinkResult simulate(const LinkConfig &cfg) {
+  Rng rng = {cfg.seed};
+  ControlLinkParser parser;
+  LinkResult res;
+
+  const double byte_us = 10e6 / cfg.baud;   // 8N1
+  double tx_free_us = 0;
+
+  ControlPayload state = {0, 0};
+  ControlPayload sent_by_seq[256] = {};
+  uint8_t seq = 0;
+  uint32_t last_sent_ms = 0;
+  bool pending = false;       // a change the receiver hasn't seen yet
+  uint32_t change_ms = 0;
+  bool have_seq = false;
+  uint8_t last_seq = 0;
+  bool first = true;
+
+  for (uint32_t now = 0; now < cfg.duration_ms; now++) {
+    // the stick moves every ~150 ms on average
+    bool changed = first;
+    if (rng.chance(1000000 / 150)) {
+      ControlPayload next = {(int8_t)((int)(rng.next() % 5) - 2), (uint8_t)(rng.next() & 1)};
+      if (next.dir != state.dir || next.button != state.button) {
+        state = next;
+        changed = true;
+        pending = true;
+        change_ms = now;
+        res.changes++;
+      }
+    }
+    if (!changed && now - last_sent_ms < HEARTBEAT_MS) continue;
+    first = false;
+    last_sent_ms = now;
+
+    uint8_t frame[CONTROL_LINK_OVERHEAD + CONTROL_LINK_MAX_DATA];
+    size_t n = controlLinkEncode(frame, sizeof(frame), seq, state);
+    sent_by_seq[seq] = state;
+    seq++;
+    res.sent++;
+
+    bool damaged = false;
+    double t_us = (now * 1000.0 > tx_free_us) ? now * 1000.0 : tx_free_us;
+    for (size_t i = 0; i < n; i++) {
+      t_us += byte_us;
+      uint8_t b = frame[i];
+      if (rng.chance(cfg.drop_ppm)) {
+        damaged = true;
+        continue;
+      }
+      if (rng.chance(cfg.corrupt_ppm)) {
+        uint8_t r = (uint8_t)rng.next();
+        if (r != b) damaged = true;
+        b = r;
+      }
+      if (!parser.feed(b)) continue;
+
+      const ControlPayload &p = parser.payload();
+      const ControlPayload &want = sent_by_seq[parser.seq()];
+      res.delivered++;
+      if (p.dir != want.dir || p.button != want.button) res.wrong++;
+      if (have_seq && parser.seq() != (uint8_t)(last_seq + 1)) res.gaps_seen++;
+      have_seq = true;
+      last_seq = parser.seq();
+
+      if (pending && p.dir == state.dir && p.button == state.button) {
+        double ms = t_us / 1000.0 - change_ms;
+        res.latency_sum_ms += ms;
+        if (ms > res.latency_max_ms) res.latency_max_ms = ms;
+        res.latency_n++;
+        pending = false;
+      }
+    }
+    tx_free_us = t_us;
+    res.damaged += damaged;
+  }
+  res.stats = parser.stats();
+  return res;
+}
+
+static void report(const char *name, const LinkConfig &cfg, const LinkResult &r) {
+  char msg[200];
+  snprintf(msg, sizeof(msg),
+           "%s @%u: sent=%u damaged=%u delivered=%u crc=%u bad=%u gaps=%u | "
+           "latency mean=%.2f ms max=%.2f ms over %u changes",
+           name, (unsigned)cfg.baud, (unsigned)r.sent, (unsigned)r.damaged, (unsigned)r.delivered,
+           (unsigned)r.stats.crc_errors, (unsigned)r.stats.bad_frames, (unsigned)r.stats.seq_gaps,
+           r.latency_n ? r.latency_sum_ms / r.latency_n : 0.0, r.latency_max_ms, (unsigned)r.latency_n);
+  TEST_MESSAGE(msg);
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_encode_layout() {
+  uint8_t f[CONTROL_LINK_OVERHEAD + CONTROL_LINK_MAX_DATA];
+  ControlPayload p = {-2, 1};
+  TEST_ASSERT_EQUAL(7, controlLinkEncode(f, sizeof(f), 9, p));
+  TEST_ASSERT_EQUAL_UINT8(CONTROL_LINK_SYNC, f[0]);
+  TEST_ASSERT_EQUAL_UINT8(9, f[2]);
+  TEST_ASSERT_EQUAL_UINT8(0xFE, f[4]);
+  TEST_ASSERT_EQUAL_UINT8(controlLinkCrc8(f + 1, 5), f[6]);
+  TEST_ASSERT_EQUAL(0, controlLinkEncode(f, 6, 0, p));
+}
+
+static void test_clean_link() {
+  LinkConfig cfg;
+  LinkResult r = simulate(cfg);
+  report("clean", cfg, r);
+  // seq wraps several times without counting a gap
+  TEST_ASSERT_GREATER_THAN_UINT32(512, r.sent);
+  TEST_ASSERT_EQUAL_UINT32(r.sent, r.delivered);
+  TEST_ASSERT_EQUAL_UINT32(0, r.stats.seq_gaps);
+  TEST_ASSERT_EQUAL_UINT32(0, r.stats.crc_errors);
+  TEST_ASSERT_EQUAL_UINT32(r.changes, r.latency_n);
+  // one 7 byte frame is 1.8 ms of wire time at 38400, at most one more
+  // can be queued ahead of it
+  TEST_ASSERT_LESS_OR_EQUAL(3.7, r.latency_max_ms);
+}
+
+static void test_corrupted_bytes_never_accepted() {
+  LinkConfig cfg;
+  cfg.corrupt_ppm = 5000;   // 0.5% of bytes
+  LinkResult r = simulate(cfg);
+  report("corrupt", cfg, r);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, r.damaged);
+  TEST_ASSERT_EQUAL_UINT32(0, r.wrong);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, r.stats.crc_errors + r.stats.bad_frames);
+}
+
+static void test_dropped_bytes_resync() {
+  LinkConfig cfg;
+  cfg.drop_ppm = 5000;
+  LinkResult r = simulate(cfg);
+  report("drop", cfg, r);
+  TEST_ASSERT_EQUAL_UINT32(0, r.wrong);
+  // a short frame can swallow the next frame's sync, but never more:
+  // each damaged frame costs at most one clean one after it
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(r.sent - 2 * r.damaged, r.delivered);
+}
+
+static void test_seq_gaps_counted() {
+  LinkConfig cfg;
+  cfg.seed = 7;
+  cfg.corrupt_ppm = 3000;
+  cfg.drop_ppm = 3000;
+  LinkResult r = simulate(cfg);
+  report("mixed", cfg, r);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, r.gaps_seen);
+  TEST_ASSERT_EQUAL_UINT32(r.gaps_seen, r.stats.seq_gaps);
+  TEST_ASSERT_EQUAL_UINT32(r.delivered, r.stats.frames);
+}
+
+static void test_latency_bounded_by_heartbeat() {
+  // a lost change goes out again on the next heartbeat, so even on a bad
+  // link the receiver catches up within a few heartbeats
+  LinkConfig cfg;
+  cfg.seed = 3;
+  cfg.corrupt_ppm = 10000;
+  cfg.drop_ppm = 10000;
+  LinkResult r = simulate(cfg);
+  report("lossy", cfg, r);
+  TEST_ASSERT_EQUAL_UINT32(0, r.wrong);
+  TEST_ASSERT_LESS_OR_EQUAL(3.0 * HEARTBEAT_MS, r.latency_max_ms);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_encode_layout);
+  RUN_TEST(test_clean_link);
+  RUN_TEST(test_corrupted_bytes_never_accepted);
+  RUN_TEST(test_dropped_bytes_resync);
+  RUN_TEST(test_seq_gaps_counted);
+  RUN_TEST(test_latency_bounded_by_heartbeat);
+  return UNITY_END();
+}
@@ -0,0 +1,165 @@
+// DeferredLog with three producer threads and the drain task on the host:
+//   pio test -e native -f test_deferred_log
+#include <atomic>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <unity.h>
+#include <vector>
+
+#include <DeferredLog.h>
+
+// collects what the drain task prints, one string per line. while
+// blocked, the drain task stalls in write() and the ring fills up
+class CapturePrint : public Print {
+public:
+  std::atomic<bool> blocked{false};
+
+  size_t write(uint8_t b) override {
+    while (blocked.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (b == '\n') {
+      _lines.push_back(_cur);
+      _cur.clear();
+    } else {
+      _cur += (char)b;
+    }
+    return 1;
+  }
+
+  std::vector<std::string> take() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<std::string> out;
+    out.swap(_lines);
+    return out;
+  }
+
+private:
+  std::mutex _mutex;
+  std::vector<std::string> _lines;
+  std::string _cur;
+};
+
+static CapturePrint capture;
+static const size_t DEPTH = 64;
+
+// waits until the drain task has written `count` records in total
+static void drainUntil(uint32_t count) {
+  for (int i = 0; i < 2000 && dlog::stats().written < count; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+static uint32_t suppressedIn(const std::string &line) {
+  const char *p = strstr(line.c_str(), " [+");
+  return p ? (uint32_t)atoi(p + 3) : 0;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_three_producers() {
+  static dlog::Site sites[3] = {{"p0 n=%u", 0}, {"p1 n=%u", 0}, {"p2 n=%u", 0}};
+  const uint32_t per_producer = 5000;
+  const dlog::Stats before = dlog::stats();
+  capture.take();
+
+  std::thread producers[3];
+  for (int p = 0; p < 3; p++) {
+    producers[p] = std::thread([p, per_producer]() {
+      for (uint32_t n = 0; n < per_producer; n++) {
+        dlog::log(sites[p], n);
+        // bursts of 16, so the drain task keeps up with part of it
+        if ((n & 15) == 15) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    });
+  }
+  for (int p = 0; p < 3; p++) producers[p].join();
+
+  dlog::Stats after = dlog::stats();
+  uint32_t queued = 3 * per_producer - (after.dropped - before.dropped);
+  drainUntil(before.written + queued);
+  after = dlog::stats();
+
+  // every record either went out or was counted as dropped
+  TEST_ASSERT_EQUAL_UINT32(3 * per_producer,
+                           (after.written - before.written) + (after.dropped - before.dropped));
+  TEST_ASSERT_EQUAL_UINT32(0, after.rate_limited - before.rate_limited);
+
+  // no line lost or mangled, each producer's records stay in order
+  std::vector<std::string> lines = capture.take();
+  TEST_ASSERT_EQUAL_UINT32(after.written - before.written, lines.size());
+  long last[3] = {-1, -1, -1};
+  for (const std::string &l : lines) {
+    unsigned p, n;
+    TEST_ASSERT_EQUAL_INT(2, sscanf(l.c_str(), "p%u n=%u", &p, &n));
+    TEST_ASSERT_TRUE(p < 3 && n < per_producer);
+    TEST_ASSERT_GREATER_THAN(last[p], (long)n);
+    last[p] = n;
+  }
+
+  char msg[100];
+  snprintf(msg, sizeof(msg), "%u records: %u written, %u dropped (ring depth %u)",
+           (unsigned)(3 * per_producer), (unsigned)(after.written - before.written),
+           (unsigned)(after.dropped - before.dropped), (unsigned)DEPTH);
+  TEST_MESSAGE(msg);
+}
+
+static void test_suppressed_survives_full_ring() {
+  static dlog::Site filler("filler %u", 0);
+  static dlog::Site limited("limited %u", 20);
+  const dlog::Stats before = dlog::stats();
+  capture.take();
+
+  // stall the drain task and fill the ring. fill again once the drain
+  // task has woken and taken its one record into the blocked write
+  capture.blocked = true;
+  uint32_t filled = 0, filler_dropped = 0;
+  for (int pass = 0; pass < 2; pass++) {
+    while (dlog::log(filler, filled)) filled++;
+    filler_dropped++;
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  }
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(DEPTH + 1, filled);
+
+  // rate limited site: first call passes the limit but finds the ring
+  // full, the rest of the window is suppressed
+  uint32_t calls = 0;
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < 50; i++, calls++) TEST_ASSERT_FALSE(dlog::log(limited, calls));
+    std::this_thread::sleep_for(std::chrono::milliseconds(25));
+  }
+
+  // let it drain, then one more record carries everything suppressed so far
+  capture.blocked = false;
+  drainUntil(before.written + filled);
+  TEST_ASSERT_TRUE(dlog::log(limited, calls));
+  calls++;
+  drainUntil(before.written + filled + 1);
+
+  dlog::Stats after = dlog::stats();
+  uint32_t emitted = 0, suppressed = 0;
+  for (const std::string &l : capture.take()) {
+    if (l.compare(0, 8, "limited ") != 0) continue;
+    emitted++;
+    suppressed += suppressedIn(l);
+  }
+  // one drop per round here, the filler's own are not this site's
+  uint32_t dropped = after.dropped - before.dropped - filler_dropped;
+  TEST_ASSERT_EQUAL_UINT32(1, emitted);
+  TEST_ASSERT_EQUAL_UINT32(3, dropped);
+  TEST_ASSERT_EQUAL_UINT32(calls, emitted + suppressed + dropped + limited.suppressed.load());
+  TEST_ASSERT_EQUAL_UINT32(0, limited.suppressed.load());
+}
+
+int main(int argc, char **argv) {
+  dlog::begin(capture, false, DEPTH);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_three_producers);
+  RUN_TEST(test_suppressed_survives_full_ring);
+  return UNITY_END();
+}
@@ -0,0 +1,105 @@
+// SeqLock with one writer thread and several readers hammering it:
+//   pio test -e native -f test_seqlock
+#include <atomic>
+#include <stdio.h>
+#include <thread>
+#include <unity.h>
+
+#include "seqlock.h"
+
+// every field derives from n, so a torn copy can't look consistent
+struct Snapshot {
+  uint32_t n;
+  uint32_t inv;
+  uint32_t sq;
+  uint8_t bytes[20];
+
+  static Snapshot make(uint32_t n) {
+    Snapshot s;
+    s.n = n;
+    s.inv = ~n;
+    s.sq = n * n;
+    for (int i = 0; i < 20; i++) s.bytes[i] = (uint8_t)(n + i);
+    return s;
+  }
+
+  bool consistent() const {
+    if (inv != ~n || sq != n * n) return false;
+    for (int i = 0; i < 20; i++) {
+      if (bytes[i] != (uint8_t)(n + i)) return false;
+    }
+    return true;
+  }
+};
+
+void setUp() {}
+void tearDown() {}
+
+static void test_single_thread_roundtrip() {
+  SeqLock<Snapshot> lock;
+  Snapshot out = Snapshot::make(0);
+  uint32_t v0 = lock.version();
+  lock.write(Snapshot::make(42));
+
+  uint32_t version;
+  TEST_ASSERT_TRUE(lock.read(out, &version));
+  TEST_ASSERT_EQUAL_UINT32(42, out.n);
+  TEST_ASSERT_TRUE(out.consistent());
+  TEST_ASSERT_EQUAL_UINT32(v0 + 2, version);
+  TEST_ASSERT_EQUAL_UINT32(version, lock.version());
+}
+
+static void test_concurrent_readers_never_torn() {
+  static SeqLock<Snapshot> lock;
+  lock.write(Snapshot::make(0));
+
+  const uint32_t writes = 2000000;
+  const int readers = 3;
+  std::atomic<bool> done{false};
+  std::atomic<uint32_t> torn{0}, backwards{0}, ok{0}, raced{0};
+
+  auto reader = [&]() {
+    uint32_t last_n = 0, last_version = 0;
+    while (!done.load(std::memory_order_relaxed)) {
+      Snapshot s;
+      uint32_t version;
+      if (!lock.read(s, &version)) {
+        raced.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      if (!s.consistent()) torn.fetch_add(1, std::memory_order_relaxed);
+      // one writer, so values and versions only move forward
+      if (s.n < last_n || version < last_version) backwards.fetch_add(1, std::memory_order_relaxed);
+      last_n = s.n;
+      last_version = version;
+      ok.fetch_add(1, std::memory_order_relaxed);
+    }
+  };
+
+  std::thread r[readers];
+  for (int i = 0; i < readers; i++) r[i] = std::thread(reader);
+  for (uint32_t n = 1; n <= writes; n++) lock.write(Snapshot::make(n));
+  done = true;
+  for (int i = 0; i < readers; i++) r[i].join();
+
+  char msg[120];
+  snprintf(msg, sizeof(msg), "%u writes, %u reads ok, %u gave up after 8 attempts",
+           (unsigned)writes, (unsigned)ok.load(), (unsigned)raced.load());
+  TEST_MESSAGE(msg);
+
+  TEST_ASSERT_EQUAL_UINT32(0, torn.load());
+  TEST_ASSERT_EQUAL_UINT32(0, backwards.load());
+  TEST_ASSERT_GREATER_THAN_UINT32(0, ok.load());
+
+  Snapshot last;
+  TEST_ASSERT_TRUE(lock.read(last));
+  TEST_ASSERT_EQUAL_UINT32(writes, last.n);
+  TEST_ASSERT_EQUAL_UINT32(2 * (writes + 1), lock.version());
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_single_thread_roundtrip);
+  RUN_TEST(test_concurrent_readers_never_torn);
+  return UNITY_END();
+}
@@ -0,0 +1,70 @@
+#include "band_blit.h"
+
+#include "scale_rows.h"
+
+bool BandBlitter::begin(int32_t dst_w, int32_t band_h, BufferArena &arena) {
+  _max_w = dst_w;
+  _band_h = band_h;
+  const size_t bytes = (size_t)dst_w * band_h * sizeof(uint16_t);
+
+  // the SPI DMA reads these directly
+  for (int i = 0; i < 2; i++) {
+    _band[i] = (uint16_t *)arena.alloc(bytes);
+    if (!_band[i]) return false;
+  }
+  return true;
+}
+
+// ===== band loop =====
+
+void BandBlitter::push(lgfx::LGFXBase &dst, const uint16_t *src, int32_t src_w, int32_t src_h,
+                       int32_t x, int32_t y, int32_t dst_w, int32_t dst_h) {
+  if (!_band[0] || !_band[1] || dst_w > _max_w || dst_w <= 0 || dst_h <= 0) return;
+
+  // pick the kernel from the scale factors once per frame
+  const bool int_zoom = (dst_w % src_w) == 0 && (dst_h % src_h) == 0;
+  const int32_t zx = dst_w / src_w;
+
+  uint32_t overlay_us = 0;
+  dst.startWrite();
+  int cur = 0;
+  NearestStep sy(src_h, dst_h);   // same stepping as the columns
+  for (int32_t row = 0; row < dst_h; row += _band_h) {
+    int32_t rows = (dst_h - row < _band_h) ? dst_h - row : _band_h;
+    uint16_t *band = _band[cur];
+
+    // pushing the previous band waited for the one before it, so this
+    // buffer is no longer being read by the DMA
+    int32_t last_sy = -1;
+    for (int32_t r = 0; r < rows; r++) {
+      uint16_t *out = band + r * dst_w;
+
+      if (sy.pos == last_sy) {
+        // repeated source row, copy the line already scaled
+        memcpy(out, out - dst_w, dst_w * sizeof(uint16_t));
+      } else {
+        last_sy = sy.pos;
+        const uint16_t *in = src + sy.pos * src_w;
+        if (int_zoom) {
+          scale_row_int(out, in, src_w, zx);
+        } else {
+          scale_row_nearest(out, in, src_w, dst_w);
+        }
+      }
+      sy.next();
+    }
+
+    // blend after the whole band is scaled: repeated rows above were copied
+    // from unblended pixels, and the timer runs per band instead of per row
+    if (_overlay) {
+      uint32_t t0 = micros();
+      for (int32_t r = 0; r < rows; r++) _overlay->compositeRow(band + r * dst_w, row + r, dst_w);
+      overlay_us += micros() - t0;
+    }
+
+    dst.pushImageDMA(x, y + row, dst_w, rows, (const lgfx::swap565_t *)band);
+    cur ^= 1;
+  }
+  dst.endWrite();
+  _overlay_us = overlay_us;
+}
@@ -0,0 +1,45 @@
+#ifndef BAND_BLIT_H
+#define BAND_BLIT_H
+
+#include "lgfx_custom_ili9341_conf.hpp"
+#include "buffer_arena.h"
+#include "palette_overlay.h"
+
+// Scales a 16-bit sprite onto the panel a few rows at a time.
+// Each band is rendered into one of two small DMA buffers and pushed with
+// pushImageDMA while the next band is rendered into the other one, so the
+// full-resolution frame never exists in RAM and the SPI bus stays busy.
+class BandBlitter {
+public:
+  // dst_w: widest area that will be pushed, band_h: rows per band.
+  // both band buffers come from arena, which must be DMA capable
+  bool begin(int32_t dst_w, int32_t band_h, BufferArena &arena);
+
+  // bytes begin() needs from the arena for these dimensions
+  static size_t bytesNeeded(int32_t dst_w, int32_t band_h) {
+    return 2 * (size_t)dst_w * band_h * sizeof(uint16_t);
+  }
+
+  // src is sprite memory (byte-swapped RGB565, stride == src_w).
+  // fills dst_w x dst_h at (x, y). integer zoom factors take a
+  // pixel-repeat path, anything else nearest neighbour reading source
+  // pixel floor(x * src_w / dst_w)
+  void push(lgfx::LGFXBase &dst, const uint16_t *src, int32_t src_w, int32_t src_h,
+            int32_t x, int32_t y, int32_t dst_w, int32_t dst_h);
+
+  // blended into every band before it is pushed, nullptr to disable.
+  // overlay coordinates are relative to the pushed area
+  void setOverlay(const PaletteOverlay *overlay) { _overlay = overlay; }
+
+  // time spent compositing the overlay during the last push()
+  uint32_t lastOverlayMicros() const { return _overlay_us; }
+
+private:
+  uint16_t *_band[2] = {nullptr, nullptr};
+  int32_t _max_w = 0;
+  int32_t _band_h = 0;
+  const PaletteOverlay *_overlay = nullptr;
+  uint32_t _overlay_us = 0;
+};
+
+#endif
@@ -0,0 +1,43 @@
+#include "buffer_arena.h"
+
+#include <esp_heap_caps.h>
+
+bool BufferArena::reserve(size_t bytes, uint32_t caps, uint32_t fallback_caps) {
+  if (_base) return false;   // reserved once, at boot
+
+  _base = (uint8_t *)heap_caps_malloc(bytes, caps);
+  if (!_base && fallback_caps) {
+    _base = (uint8_t *)heap_caps_malloc(bytes, fallback_caps);
+    if (_base) {
+      _stats.fallbacks++;
+      caps = fallback_caps;
+    }
+  }
+  if (!_base) return false;
+
+  _stats.capacity = bytes;
+  _stats.caps = caps;
+  return true;
+}
+
+void *BufferArena::alloc(size_t bytes, size_t align) {
+  size_t start = (_stats.used + align - 1) & ~(align - 1);
+  if (!_base || start + bytes > _stats.capacity) {
+    _stats.failures++;
+    return nullptr;
+  }
+  _stats.used = start + bytes;
+  if (_stats.used > _stats.peak) _stats.peak = _stats.used;
+  _stats.allocs++;
+  return _base + start;
+}
+
+void BufferArena::printStats(Print &out, const char *name) const {
+  out.printf("%s: used=%u peak=%u cap=%u allocs=%u fail=%u fallback=%u\n",
+             name, (unsigned)_stats.used, (unsigned)_stats.peak, (unsigned)_stats.capacity,
+             (unsigned)_stats.allocs, (unsigned)_stats.failures, (unsigned)_stats.fallbacks);
+  // how chopped up the source heap is after the reservation
+  out.printf("%s: heap free=%u largest=%u\n", name,
+             (unsigned)heap_caps_get_free_size(_stats.caps),
+             (unsigned)heap_caps_get_largest_free_block(_stats.caps));
+}
@@ -0,0 +1,38 @@
+#ifndef BUFFER_ARENA_H
+#define BUFFER_ARENA_H
+
+#include <Arduino.h>
+
+struct ArenaStats {
+  size_t capacity = 0;
+  size_t used = 0;
+  size_t peak = 0;
+  uint32_t allocs = 0;
+  uint32_t failures = 0;    // alloc() calls that did not fit
+  uint32_t fallbacks = 0;   // reserve() had to use the fallback caps
+  uint32_t caps = 0;        // heap caps the block actually came from
+};
+
+// One block reserved from a chosen heap at boot, then handed out with a
+// bump pointer. Long-lived buffers (sprites, band buffers, receive
+// buffers) come from here so they never fragment the shared DMA heap.
+class BufferArena {
+public:
+  // caps are MALLOC_CAP_* flags. fallback_caps is tried when the first
+  // heap can't supply the block, 0 means fail instead
+  bool reserve(size_t bytes, uint32_t caps, uint32_t fallback_caps = 0);
+
+  // nullptr when the arena is full
+  void *alloc(size_t bytes, size_t align = 4);
+
+  const ArenaStats &stats() const { return _stats; }
+
+  // arena usage plus free/largest block of the heap it came from
+  void printStats(Print &out, const char *name) const;
+
+private:
+  uint8_t *_base = nullptr;
+  ArenaStats _stats;
+};
+
+#endif
@@ -0,0 +1,65 @@
+#include "joystick_filter.h"
+
+#include <stdlib.h>
+
+// ===== filter =====
+
+void JoystickFilter::configure(const JoystickConfig &cfg) {
+  _cfg = cfg;
+  _state = {0, 0};
+  _sign_x = 0;
+  _sign_y = 0;
+  _btn_count = 0;
+}
+
+// -1, 0 or +1 for one axis. entering a side needs |delta| > deadzone,
+// staying on the same side only needs |delta| > deadzone - hysteresis
+int8_t JoystickFilter::axisSign(int32_t delta, uint16_t deadzone, uint16_t hysteresis, int8_t prev) {
+  int32_t hold = (hysteresis < deadzone) ? (int32_t)deadzone - hysteresis : 0;
+  if (prev > 0 && delta > hold) return 1;
+  if (prev < 0 && delta < -hold) return -1;
+  if (delta > (int32_t)deadzone) return 1;
+  if (delta < -(int32_t)deadzone) return -1;
+  return 0;
+}
+
+bool JoystickFilter::update(uint16_t x, uint16_t y, bool pressed) {
+  _sign_x = axisSign((int32_t)x - _cfg.center_x, _cfg.deadzone_x, _cfg.hysteresis, _sign_x);
+  _sign_y = axisSign((int32_t)y - _cfg.center_y, _cfg.deadzone_y, _cfg.hysteresis, _sign_y);
+
+  controlState next = _state;
+
+  // vertical wins over horizontal, same as the old threshold chain
+  if (_sign_y != 0) {
+    next.dir = _sign_y;          // 1=UP, -1=DOWN
+  } else if (_sign_x != 0) {
+    next.dir = 2 * _sign_x;      // 2=RIGHT, -2=LEFT
+  } else {
+    next.dir = 0;                // CENTER
+  }
+
+  // button only flips after debounce_samples agreeing reads
+  uint8_t level = pressed ? 1 : 0;
+  if (level != _state.button) {
+    if (++_btn_count >= _cfg.debounce_samples) {
+      next.button = level;
+      _btn_count = 0;
+    }
+  } else {
+    _btn_count = 0;
+  }
+
+  bool changed = (next.dir != _state.dir) || (next.button != _state.button);
+  _state = next;
+  return changed;
+}
+
+// a stick held off center at boot would otherwise become the new center,
+// leaving that direction stuck active and the opposite one unreachable
+bool JoystickFilter::calibrate(JoystickConfig &cfg, uint16_t avg_x, uint16_t avg_y) {
+  bool ok_x = abs((int32_t)avg_x - cfg.center_x) <= cfg.deadzone_x;
+  bool ok_y = abs((int32_t)avg_y - cfg.center_y) <= cfg.deadzone_y;
+  if (ok_x) cfg.center_x = avg_x;
+  if (ok_y) cfg.center_y = avg_y;
+  return ok_x && ok_y;
+}
@@ -0,0 +1,70 @@
+#ifndef JOYSTICK_FILTER_H
+#define JOYSTICK_FILTER_H
+
+#include <stdint.h>
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+// structure to hold control states
+struct controlState {
+  int8_t dir;   // -2=left, -1=down, 0=center, 1=up, 2=right
+  uint8_t button;
+};
+
+// joystick tuning, raw ADC counts (12 bit, 11 dB attenuation)
+struct JoystickConfig {
+#ifdef ARDUINO
+  uint8_t pin_x = A0;
+  uint8_t pin_y = A1;
+#else
+  uint8_t pin_x = 0;   // host builds only run the filter
+  uint8_t pin_y = 0;
+#endif
+  uint8_t pin_button = 13;
+
+  // resting position, overwritten at boot when calibrate is set
+  uint16_t center_x = 1900;
+  uint16_t center_y = 1960;
+  bool calibrate = true;
+
+  // distance from center needed to leave CENTER on each axis
+  uint16_t deadzone_x = 250;
+  uint16_t deadzone_y = 300;
+  // an active direction is held until the axis drops this far back
+  // inside the deadzone, so noise at the edge can't chatter
+  uint16_t hysteresis = 60;
+
+  // button must read the same level this many samples in a row
+  uint8_t debounce_samples = 3;
+
+  uint16_t sample_period_ms = 5;
+};
+
+// pure quantizer: raw samples in, debounced control state out.
+// no hardware access so it can be fed recorded ADC traces
+class JoystickFilter {
+public:
+  void configure(const JoystickConfig &cfg);
+
+  // returns true when dir or button changed with this sample
+  bool update(uint16_t x, uint16_t y, bool pressed);
+
+  controlState state() const { return _state; }
+
+  // takes the averaged boot reading as the new center, per axis, unless
+  // it sits more than a deadzone from the configured one (stick held
+  // during boot). returns false if either axis kept its default
+  static bool calibrate(JoystickConfig &cfg, uint16_t avg_x, uint16_t avg_y);
+
+private:
+  static int8_t axisSign(int32_t delta, uint16_t deadzone, uint16_t hysteresis, int8_t prev);
+
+  JoystickConfig _cfg;
+  controlState _state = {0, 0};
+  int8_t _sign_x = 0;
+  int8_t _sign_y = 0;
+  uint8_t _btn_count = 0;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#include "joystick_input.h"
+
+// ===== sampling task =====
+
+bool JoystickInput::begin(const JoystickConfig &cfg) {
+  _cfg = cfg;
+
+  analogSetPinAttenuation(_cfg.pin_x, ADC_11db); // full range 3.3V
+  analogSetPinAttenuation(_cfg.pin_y, ADC_11db);
+  // With INPUT_PULLUP: LOW = pressed, HIGH = not pressed
+  pinMode(_cfg.pin_button, INPUT_PULLUP);
+
+  // stick is assumed at rest during boot, average a few reads for center
+  if (_cfg.calibrate) {
+    uint32_t sx = 0, sy = 0;
+    const int n = 16;
+    for (int i = 0; i < n; i++) {
+      sx += analogRead(_cfg.pin_x);
+      sy += analogRead(_cfg.pin_y);
+      delay(2);
+    }
+    if (!JoystickFilter::calibrate(_cfg, sx / n, sy / n)) {
+      Serial.printf("joystick: boot reading %u,%u too far off center, using %u,%u\n",
+                    (unsigned)(sx / n), (unsigned)(sy / n), _cfg.center_x, _cfg.center_y);
+    }
+  }
+  _filter.configure(_cfg);
+
+  _queue = xQueueCreate(8, sizeof(controlState));
+  if (!_queue) return false;
+
+  return xTaskCreate(taskEntry, "joystick", 2048, this, 2, &_task) == pdPASS;
+}
+
+bool JoystickInput::waitEvent(controlState &out, uint32_t timeout_ms) {
+  if (!_queue) {
+    delay(timeout_ms);
+    return false;
+  }
+  return xQueueReceive(_queue, &out, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+}
+
+void JoystickInput::taskEntry(void *arg) {
+  static_cast<JoystickInput *>(arg)->run();
+}
+
+void JoystickInput::run() {
+  TickType_t wake = xTaskGetTickCount();
+  const TickType_t period = pdMS_TO_TICKS(_cfg.sample_period_ms) ? pdMS_TO_TICKS(_cfg.sample_period_ms) : 1;
+
+  for (;;) {
+    vTaskDelayUntil(&wake, period);
+
+    uint16_t x = analogRead(_cfg.pin_x);
+    uint16_t y = analogRead(_cfg.pin_y);
+    bool pressed = digitalRead(_cfg.pin_button) == LOW;
+
+    if (!_filter.update(x, y, pressed)) continue;
+
+    controlState ev = _filter.state();
+    // keep the newest event if the consumer fell behind
+    if (xQueueSend(_queue, &ev, 0) != pdTRUE) {
+      controlState dropped;
+      xQueueReceive(_queue, &dropped, 0);
+      xQueueSend(_queue, &ev, 0);
+    }
+  }
+}
@@ -0,0 +1,30 @@
+#ifndef JOYSTICK_INPUT_H
+#define JOYSTICK_INPUT_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+
+#include "joystick_filter.h"
+
+// timer-paced sampling task that pushes change events into a queue
+class JoystickInput {
+public:
+  bool begin(const JoystickConfig &cfg = JoystickConfig());
+
+  // blocks until the control state changes or timeout_ms elapses.
+  // returns true and fills out when a change event was received
+  bool waitEvent(controlState &out, uint32_t timeout_ms);
+
+private:
+  static void taskEntry(void *arg);
+  void run();
+
+  JoystickConfig _cfg;
+  JoystickFilter _filter;
+  QueueHandle_t _queue = nullptr;
+  TaskHandle_t _task = nullptr;
+};
+
+#endif
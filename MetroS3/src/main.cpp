@@ -1,7 +1,12 @@
 #include <Arduino.h>
 #include "ESPNowCam.h"
+#include <DeferredLog.h>
 
 #include "lgfx_custom_ili9341_conf.hpp"
+#include "joystick_input.h"
+#include "band_blit.h"
+#include "buffer_arena.h"
+#include "palette_overlay.h"
 #include <LGFX_TFT_eSPI.hpp>
 
 // pins for Metro ESP32S3
@@ -39,29 +44,60 @@ static const int SRC_H = 120;
 // sprite to hold decoded frame
 static LGFX_Sprite camSprite(&lcd);
 
+// streams the scaled sprite to the panel in DMA bands
+static BandBlitter blitter;
+static const int BAND_H = 16;   // 2 x 320x16 RGB565 = 20 KB
+
+// every panel showing the camera view. the JPEG is decoded once into
+// camSprite, then each target scales it through its own blitter and bus
+struct ViewTarget {
+  lgfx::LGFXBase *dst;
+  BandBlitter *blitter;
+  int32_t x, y, w, h;
+  uint32_t push_us;   // cost of the last push to this target
+};
+static ViewTarget views[] = {
+  {&lcd, &blitter, 0, 0, W, H, 0},   // view 0: ILI9341
+};
+static const size_t VIEW_COUNT = sizeof(views) / sizeof(views[0]);
+
 // display globals
 int32_t dw = 320;
 int32_t dh = 240;
 
 // *** buffers ***
 static const size_t JPG_MAX = 96 * 1024;
-static uint8_t *jpg = nullptr;
+// two receive buffers: the radio (Wi-Fi task, core 0) fills one while
+// the decode task (core 1) works on the other
+static uint8_t *jpgBuf[2] = {nullptr, nullptr};
+static volatile uint8_t rxIdx = 0;
+static volatile bool decodeBusy = false;
+static uint32_t framesDropped = 0;
+
+struct FrameMsg {
+  uint8_t idx;
+  uint32_t length;
+};
+static QueueHandle_t frameQueue = nullptr;
+
+// reserved once at boot, every long-lived buffer is carved from these
+static BufferArena dmaArena;     // band buffers read by SPI DMA
+static BufferArena frameArena;   // decoded sprite + HUD
+static BufferArena rxArena;      // JPEG receive buffers
+static const size_t SPRITE_BYTES = SRC_W * SRC_H * sizeof(uint16_t);
+
+// HUD drawn on top of the camera view, blended in by the band blitter
+static PaletteOverlay hud;
+static const size_t HUD_BYTES = ((W + 3) / 4) * H + H;   // 2bpp + row flags
+enum { HUD_CROSS = 1, HUD_ARROW = 2, HUD_BUTTON = 3 };
 
 // simple FPS/diag
 static uint32_t last_ms = 0;
 static uint32_t frames = 0;
 
 
-// === input defines ===
-#define ANALOG_PIN_X A0
-#define ANALOG_PIN_Y A1
-#define BUTTON_PIN   13
-
-// structure to hold control states
-struct controlState {
-  int8_t dir;   // -2=left, -1=down, 0=center, 1=up, 2=right
-  uint8_t button;
-};
+// joystick sampled on its own task, changes arrive as events
+static JoystickInput joystick;
 
 // last sent control state
 controlState lastSend = {0, 0};
@@ -70,14 +106,39 @@ unsigned long lastSentMs = 0;
 // maximum ms between sends
 const unsigned long HEARTBEAT_MS = 200; // 200ms for 5Hz
 
-
-/* *** FOR QVGA SENDER FRAME SIZE ***
-static void onDataReady(uint32_t length) {
-  if (!length || length > JPG_MAX) {
-    Serial.printf("onDataReady: bad len=%u (max=%u)\n", (unsigned)length, (unsigned)JPG_MAX);
-    return;
+// what the HUD currently shows, redrawn only when the control state moves
+static int8_t hudDir = 127;
+static uint8_t hudButton = 255;
+
+static void drawHud(const controlState &c) {
+  hud.clear();
+
+  // crosshair
+  hud.fillRect(W / 2 - 10, H / 2, 21, 1, HUD_CROSS);
+  hud.fillRect(W / 2, H / 2 - 10, 1, 21, HUD_CROSS);
+
+  // direction arrow against the matching edge, one rect per row of the triangle
+  const int n = 12;
+  for (int i = 0; i < n; i++) {
+    switch (c.dir) {
+      case 1:  hud.fillRect(W / 2 - i, 8 + i, 2 * i + 1, 1, HUD_ARROW); break;      // UP
+      case -1: hud.fillRect(W / 2 - i, H - 9 - i, 2 * i + 1, 1, HUD_ARROW); break;  // DOWN
+      case -2: hud.fillRect(8 + i, H / 2 - i, 1, 2 * i + 1, HUD_ARROW); break;      // LEFT
+      case 2:  hud.fillRect(W - 9 - i, H / 2 - i, 1, 2 * i + 1, HUD_ARROW); break;  // RIGHT
+      default: break;
+    }
   }
 
+  // button held
+  if (c.button) hud.fillRect(W - 20, 8, 12, 12, HUD_BUTTON);
+
+  hudDir = c.dir;
+  hudButton = c.button;
+}
+
+/* *** FOR QVGA SENDER FRAME SIZE ***
+// swap in for the QQVGA showFrame below, decodeTask calls it the same way
+static void showFrame(const uint8_t *jpg, uint32_t length) {
   lcd.startWrite();
   // LovyanGFX decodes JPEG and pushes in tiles safely for ESP32-S3
   lcd.drawJpg(jpg, length, 0, 0);   // x=0, y=0
@@ -87,7 +148,7 @@ static void onDataReady(uint32_t length) {
   frames++;
   uint32_t now = millis();
   if (now - last_ms >= 1000) {
-    Serial.printf("fps=%u, last_jpg_bytes=%u\n", frames, (unsigned)length);
+    DLOG("fps=%u, last_jpg_bytes=%u", frames, length);
     frames = 0;
     last_ms = now;
   }
@@ -95,67 +156,74 @@ static void onDataReady(uint32_t length) {
 */
 
 // *** FOR QQVGA SENDER FRAME SIZE ***
-static void onDataReady(uint32_t length) {
-  if (!length || length > JPG_MAX) {
-    Serial.printf("onDataReady: bad len=%u (max=%u)\n", (unsigned)length, (unsigned)JPG_MAX);
-    return;
-  }
-
+static void showFrame(const uint8_t *jpg, uint32_t length) {
   // Decode JPEG into the sprite at native resolution (160x120)
-  camSprite.fillScreen(TFT_BLACK);                     // not strictly required, but nice
+  // no fillScreen first: every MCU of a full frame overwrites the sprite,
+  // so clearing it was a wasted 38 KB pass per frame
+  uint32_t t0 = micros();
   camSprite.drawJpg(jpg, length, 0, 0);                // draw at (0,0) in the sprite
+  uint32_t decode_us = micros() - t0;
 
-  // Compute scale factors to fill the 320x240 TFT
-  const float sx = float(W) / float(SRC_W);            // 320/160 = 2.0
-  const float sy = float(H) / float(SRC_H);            // 240/120 = 2.0
+  // loop() owns lastSend, a stale read only delays the HUD by a frame
+  if (lastSend.dir != hudDir || lastSend.button != hudButton) {
+    drawHud(lastSend);
+  }
 
-  // Push scaled sprite centered on the TFT
-  lcd.startWrite();
-  camSprite.pushRotateZoom(W / 2, H / 2, 0.0f, sx, sy);  // angle=0, zoom=2x in both directions
-  lcd.endWrite();
+  // Scale the sprite onto each target, band by band over DMA
+  const uint16_t *frame = (const uint16_t*)camSprite.getBuffer();
+  for (size_t i = 0; i < VIEW_COUNT; i++) {
+    ViewTarget &v = views[i];
+    t0 = micros();
+    v.blitter->push(*v.dst, frame, SRC_W, SRC_H, v.x, v.y, v.w, v.h);
+    v.push_us = micros() - t0;
+  }
 
   // crude FPS
   frames++;
   uint32_t now = millis();
   if (now - last_ms >= 1000) {
-    Serial.printf("fps=%u, last_jpg_bytes=%u\n", frames, (unsigned)length);
+    dlog::Stats ls = dlog::stats();
+    DLOG("fps=%u, last_jpg_bytes=%u, decode_us=%u, overlay_us=%u, dropped=%u, log_dropped=%u, log_limited=%u",
+         frames, length, decode_us, blitter.lastOverlayMicros(), framesDropped, ls.dropped, ls.rate_limited);
+    for (size_t i = 0; i < VIEW_COUNT; i++) {
+      DLOG("  view %u push_us=%u", i, views[i].push_us);
+    }
     frames = 0;
     last_ms = now;
   }
 }
 
-// prints joystick and button states
-// button state is printed only once when first pressed
-// this simulates the single-use CST device functionality
-
-// need to refine zone thresholds experimentally
-static controlState quantizeInputs(){
-  controlState c = {0, 0};
-    // read analog joystick positions
-  int x = analogRead(ANALOG_PIN_X);
-  int y = analogRead(ANALOG_PIN_Y);
-
-  if(x < 1650) {
-    c.dir = -2; // LEFT
-  } else if(x > 2150) {
-    c.dir = 2;  // RIGHT
-  }
-  if(y < 1660) {
-    c.dir = -1; // DOWN
-  } else if(y > 2260) {
-    c.dir = 1;  // UP
-  }
-  if( (x >= 1650) && (x <= 2150) && (y >= 1660) && (y <= 2260) ) {
-    c.dir = 0;  // CENTER
-  }
-  // LEVEL-BASED BUTTON:
-  // With INPUT_PULLUP: LOW = pressed, HIGH = not pressed
-  if (digitalRead(BUTTON_PIN) == LOW) {
-    c.button = 1;     // pressed
-  } else {
-    c.button = 0;     // not pressed
+// runs in the Wi-Fi task: hand the finished buffer to the decoder and
+// keep receiving into the other one
+static void onDataReady(uint32_t length) {
+  if (!length || length > JPG_MAX) {
+    DLOG_EVERY(1000, "onDataReady: bad len=%u (max=%u)", length, JPG_MAX);
+    return;
+  }
+
+  if (decodeBusy) {
+    // both buffers in use, drop this frame and reuse its buffer
+    framesDropped++;
+    return;
+  }
+  decodeBusy = true;
+
+  FrameMsg msg = {rxIdx, length};
+  rxIdx ^= 1;
+  radio.setRecvBuffer(jpgBuf[rxIdx]);
+  xQueueSend(frameQueue, &msg, 0);
+}
+
+// decode + push, pinned to the app core so it overlaps with reception.
+// runs at loopTask's priority so the two time-slice: above it, a frame's
+// decode and SPI wait would hold joystick sends back for ~45 ms
+static void decodeTask(void *arg) {
+  FrameMsg msg;
+  for (;;) {
+    if (xQueueReceive(frameQueue, &msg, portMAX_DELAY) != pdTRUE) continue;
+    showFrame(jpgBuf[msg.idx], msg.length);
+    decodeBusy = false;
   }
-  return c;
 }
 
 // callback when data is sent
@@ -167,6 +235,7 @@ void OnDataSent(const uint8_t *mac_addr, esp_now_send_status_t status) {
 
 void setup() {
   Serial.begin(115200);
+  dlog::begin(Serial);   // hot paths log through the deferred ring
   delay(1000);
 
   // ===== Display Init =====
@@ -177,28 +246,66 @@ void setup() {
   lcd.setColorDepth(16);
   lcd.fillScreen(TFT_BLACK);
 
+  // ===== Arenas =====
+  // bands: internal, the SPI DMA can't read PSRAM.
+  // sprite + HUD: written during decode and read by every band, so
+  // internal RAM for speed, PSRAM only if the heap is short.
+  // JPEG: PSRAM. 2 x 96 KB won't fit internal next to the Wi-Fi buffers,
+  // and the decoder reads each frame once, front to back, through the cache
+  if (!dmaArena.reserve(BandBlitter::bytesNeeded(W, BAND_H), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL) ||
+      !frameArena.reserve(SPRITE_BYTES + HUD_BYTES, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT, MALLOC_CAP_SPIRAM) ||
+      !rxArena.reserve(2 * JPG_MAX, MALLOC_CAP_SPIRAM, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)) {
+    Serial.println("arena reserve failed");
+    while (1) delay(1000);
+  }
+
   // L147-153 for QQVGA sender
   // ===== Sprite init (160x120 buffer) =====
   camSprite.setColorDepth(16);
-  // optional: if you have PSRAM and want to use it
-  // camSprite.setPsram(true);
-  camSprite.createSprite(SRC_W, SRC_H);
+  camSprite.setBuffer(frameArena.alloc(SPRITE_BYTES), SRC_W, SRC_H);
   camSprite.fillScreen(TFT_BLACK);
 
+  // ===== Band buffers for the scaled push =====
+  if (!blitter.begin(W, BAND_H, dmaArena)) {
+    Serial.println("band buffer alloc failed");
+    while (1) delay(1000);
+  }
+
+  // ===== HUD overlay =====
+  if (hud.begin(W, H, frameArena)) {
+    hud.setEntry(HUD_CROSS, TFT_WHITE, 20);    // see-through
+    hud.setEntry(HUD_ARROW, TFT_YELLOW, 24);
+    hud.setEntry(HUD_BUTTON, TFT_RED, 32);     // opaque
+    drawHud(lastSend);
+    blitter.setOverlay(&hud);
+  } else {
+    Serial.println("hud alloc failed");
+  }
+
   // ===== Radio Init =====
   //radio.setTarget(MAC_RECV);
   //radio.init();
 
  // ---- Buffers ----
-  jpg = (uint8_t*) malloc(JPG_MAX);
-  if (!jpg) {
+  jpgBuf[0] = (uint8_t*) rxArena.alloc(JPG_MAX);
+  jpgBuf[1] = (uint8_t*) rxArena.alloc(JPG_MAX);
+  if (!jpgBuf[0] || !jpgBuf[1]) {
     Serial.println("jpg alloc failed");
     while (1) delay(1000);
   }
-
+  dmaArena.printStats(Serial, "dma arena");
+  frameArena.printStats(Serial, "frame arena");
+  rxArena.printStats(Serial, "rx arena");
+
+  // ---- Decoder task ----
+  frameQueue = xQueueCreate(1, sizeof(FrameMsg));
+  if (!frameQueue || xTaskCreatePinnedToCore(decodeTask, "jpg_decode", 8192, nullptr, 1, nullptr, 1) != pdPASS) {
+    Serial.println("decode task start failed");
+    while (1) delay(1000);
+  }
 
   // ---- ESPNOW  receiver ----
-  radio.setRecvBuffer(jpg);             // receive compressed JPEG into 'jpg'
+  radio.setRecvBuffer(jpgBuf[rxIdx]);   // receive compressed JPEG into the current buffer
   radio.setRecvCallback(onDataReady);
 
   // ---- ESPNOW init ----
@@ -217,15 +324,20 @@ void setup() {
   // get the status of Transmitted packet
   esp_now_register_send_cb(OnDataSent);
 
-  analogSetAttenuation(ADC_11db); // set full range 3.3V for the analog pins
-
-  pinMode(BUTTON_PIN, INPUT_PULLUP); // set pin mode for button
+  // ===== Joystick Init =====
+  // center is calibrated here, keep the stick at rest during boot
+  if (!joystick.begin()) {
+    Serial.println("joystick task start failed");
+  }
 }
 
 void loop(void) {
-  controlState cur = quantizeInputs();
+  // sleep until the joystick reports a change or the heartbeat is due
+  uint32_t since = millis() - lastSentMs;
+  uint32_t wait = (since >= HEARTBEAT_MS) ? 0 : HEARTBEAT_MS - since;
 
-  bool stateChanged = (cur.dir != lastSend.dir) || (cur.button != lastSend.button);
+  controlState cur = lastSend;
+  bool stateChanged = joystick.waitEvent(cur, wait);
   bool heartbeat = (millis() - lastSentMs) >= HEARTBEAT_MS; // 5 Hz
 
   // if state changed or heartbeat timeout, send update
@@ -235,11 +347,11 @@ void loop(void) {
     if (result == ESP_OK) {
       //Serial.println("Sent with success");
     } else {
-      Serial.println("ESPNOW Send Failed");
+      DLOG_EVERY(1000, "ESPNOW Send Failed");
     }
     lastSend = cur;
     lastSentMs = millis();
 
-    Serial.printf("Sent: dir=%d, button=%d\n", (int)cur.dir, (int)cur.button);
+    DLOG("Sent: dir=%d, button=%d", cur.dir, cur.button);
   }
 }
\ No newline at end of file
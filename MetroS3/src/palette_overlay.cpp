@@ -0,0 +1,69 @@
+#include "palette_overlay.h"
+
+#include "rgb565.h"
+
+bool PaletteOverlay::begin(int32_t w, int32_t h, BufferArena &arena) {
+  _w = w;
+  _h = h;
+  _stride = (w + 3) >> 2;   // 4 pixels per byte, leftmost in the top bits
+  _buf = (uint8_t *)arena.alloc(_stride * h);
+  _row_used = (uint8_t *)arena.alloc(h, 1);
+  if (!_buf || !_row_used) return false;
+  clear();
+  return true;
+}
+
+void PaletteOverlay::setEntry(uint8_t index, uint16_t rgb565, uint8_t alpha) {
+  if (index == 0 || index > 3) return;   // 0 stays transparent
+  Entry &e = _pal[index];
+  e.swapped = (rgb565 >> 8) | (rgb565 << 8);
+  e.spread = spread565(e.swapped);
+  e.alpha = alpha > 32 ? 32 : alpha;
+}
+
+void PaletteOverlay::clear() {
+  if (!_buf) return;
+  memset(_buf, 0, _stride * _h);
+  memset(_row_used, 0, _h);
+}
+
+void PaletteOverlay::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint8_t index) {
+  if (!_buf) return;
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if (x + w > _w) w = _w - x;
+  if (y + h > _h) h = _h - y;
+  if (w <= 0 || h <= 0) return;
+
+  index &= 3;
+  for (int32_t row = y; row < y + h; row++) {
+    uint8_t *line = _buf + row * _stride;
+    for (int32_t col = x; col < x + w; col++) {
+      uint8_t shift = 6 - ((col & 3) << 1);
+      line[col >> 2] = (line[col >> 2] & ~(3 << shift)) | (index << shift);
+    }
+    if (index) _row_used[row] = 1;
+  }
+}
+
+bool PaletteOverlay::compositeRow(uint16_t *out, int32_t y, int32_t w) const {
+  if (!_buf || y < 0 || y >= _h || !_row_used[y]) return false;
+  if (w > _w) w = _w;
+
+  const uint8_t *line = _buf + y * _stride;
+  for (int32_t col = 0; col < w; col += 4) {
+    uint8_t bits = line[col >> 2];
+    if (!bits) continue;   // 4 transparent pixels, the common case
+    for (int32_t k = 0; k < 4 && col + k < w; k++, bits <<= 2) {
+      uint8_t idx = bits >> 6;
+      if (!idx) continue;
+      const Entry &e = _pal[idx];
+      if (e.alpha >= 32) {
+        out[col + k] = e.swapped;
+      } else if (e.alpha) {
+        out[col + k] = pack565(lerp565(spread565(out[col + k]), e.spread, e.alpha));
+      }
+    }
+  }
+  return true;
+}
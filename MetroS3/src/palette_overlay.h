@@ -0,0 +1,43 @@
+#ifndef PALETTE_OVERLAY_H
+#define PALETTE_OVERLAY_H
+
+#include <Arduino.h>
+
+#include "buffer_arena.h"
+
+// 2 bits per pixel HUD layer, blended into the camera band buffers before
+// they go out over SPI, so overlays add no panel traffic of their own.
+// Index 0 is always transparent, 1..3 map to a color with its own alpha.
+class PaletteOverlay {
+public:
+  bool begin(int32_t w, int32_t h, BufferArena &arena);
+
+  // alpha: 0 (invisible) .. 32 (opaque)
+  void setEntry(uint8_t index, uint16_t rgb565, uint8_t alpha);
+
+  void clear();
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint8_t index);
+
+  // blends overlay row y into w sprite-order pixels at out.
+  // returns false when the row is fully transparent (nothing written)
+  bool compositeRow(uint16_t *out, int32_t y, int32_t w) const;
+
+  int32_t width() const { return _w; }
+  int32_t height() const { return _h; }
+
+private:
+  struct Entry {
+    uint16_t swapped;   // color in sprite byte order, for opaque stores
+    uint32_t spread;    // color spread for blending
+    uint8_t alpha;
+  };
+
+  uint8_t *_buf = nullptr;
+  uint8_t *_row_used = nullptr;   // per row: anything non-transparent
+  int32_t _w = 0;
+  int32_t _h = 0;
+  int32_t _stride = 0;
+  Entry _pal[4] = {};
+};
+
+#endif
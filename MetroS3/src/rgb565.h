@@ -0,0 +1,23 @@
+#ifndef RGB565_H
+#define RGB565_H
+
+#include <stdint.h>
+
+// helpers for sprite-order (byte-swapped) RGB565 pixels
+
+// spread RGB565 so R, G and B can be weighted in one 32-bit multiply
+static inline uint32_t spread565(uint16_t swapped) {
+  uint32_t v = (uint16_t)((swapped >> 8) | (swapped << 8));
+  return (v | (v << 16)) & 0x07E0F81F;
+}
+
+static inline uint32_t lerp565(uint32_t a, uint32_t b, uint32_t w) {  // w: 0..32
+  return ((a * (32 - w) + b * w) >> 5) & 0x07E0F81F;
+}
+
+static inline uint16_t pack565(uint32_t v) {
+  uint16_t c = (uint16_t)(v | (v >> 16));
+  return (c >> 8) | (c << 8);
+}
+
+#endif
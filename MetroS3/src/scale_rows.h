@@ -0,0 +1,54 @@
+#ifndef SCALE_ROWS_H
+#define SCALE_ROWS_H
+
+#include <stdint.h>
+
+// row kernels used by the band blitter, no hardware access.
+// all pixels are sprite order (byte-swapped RGB565)
+
+// walks floor(i * src / dst) for i = 0, 1, 2, ... without a divide per
+// step. a 16.16 step can't hit that exactly once dst passes 256, so the
+// index advances by the quotient and carries the remainder
+struct NearestStep {
+  int32_t pos = 0;
+  int32_t err = 0;
+  int32_t whole, part, den;
+
+  NearestStep(int32_t src, int32_t dst) : whole(src / dst), part(src % dst), den(dst) {}
+
+  void next() {
+    pos += whole;
+    err += part;
+    if (err >= den) {
+      err -= den;
+      pos++;
+    }
+  }
+};
+
+// fractional zoom, nearest neighbour
+static inline void scale_row_nearest(uint16_t *out, const uint16_t *in, int32_t src_w, int32_t dst_w) {
+  NearestStep sx(src_w, dst_w);
+  for (int32_t c = 0; c < dst_w; c++, sx.next()) {
+    out[c] = in[sx.pos];
+  }
+}
+
+// integer zoom, each source pixel repeated zx times
+static inline void scale_row_int(uint16_t *out, const uint16_t *in, int32_t src_w, int32_t zx) {
+  if (zx == 2) {
+    // band rows start 4-byte aligned, so write both copies in one store
+    uint32_t *out32 = (uint32_t *)out;
+    for (int32_t c = 0; c < src_w; c++) {
+      uint32_t p = in[c];
+      out32[c] = p | (p << 16);
+    }
+    return;
+  }
+  for (int32_t c = 0; c < src_w; c++) {
+    uint16_t p = in[c];
+    for (int32_t k = 0; k < zx; k++) *out++ = p;
+  }
+}
+
+#endif
@@ -0,0 +1,147 @@
+// replays ADC traces through JoystickFilter on the host:
+//   pio test -e native -f test_joystick_filter
+#include <unity.h>
+
+#include "joystick_filter.h"
+
+// one 5 ms sample as the task reads it
+struct Sample {
+  uint16_t x, y;
+  bool pressed;
+};
+
+// events the sampling task would have queued for loop()
+struct Events {
+  controlState ev[32];
+  int n = 0;
+};
+
+static Events replay(JoystickFilter &f, const Sample *s, int n) {
+  Events out;
+  for (int i = 0; i < n; i++) {
+    if (f.update(s[i].x, s[i].y, s[i].pressed) && out.n < 32) out.ev[out.n++] = f.state();
+  }
+  return out;
+}
+
+#define REPLAY(f, trace) replay(f, trace, sizeof(trace) / sizeof(trace[0]))
+
+static JoystickFilter filter;
+
+void setUp() {
+  filter.configure(JoystickConfig());   // center 1900/1960, deadzone 250/300
+}
+
+void tearDown() {}
+
+// stick at rest, ADC noise of a few dozen counts
+static const Sample REST[] = {
+  {1893, 1971, 0}, {1911, 1948, 0}, {1902, 1960, 0}, {1874, 1985, 0}, {1926, 1939, 0},
+  {1899, 1957, 0}, {1880, 1992, 0}, {1917, 1944, 0}, {1905, 1966, 0}, {1888, 1953, 0},
+};
+
+// pushed up, held, released back through the deadzone edge
+static const Sample PUSH_UP[] = {
+  {1902, 1960, 0}, {1910, 2120, 0}, {1906, 2290, 0}, {1899, 2410, 0}, {1903, 2890, 0},
+  {1897, 3610, 0}, {1905, 4095, 0}, {1901, 4095, 0}, {1898, 3340, 0}, {1904, 2500, 0},
+  {1900, 2090, 0}, {1902, 1975, 0}, {1899, 1962, 0},
+};
+
+// resting just past the right deadzone edge (center + 250), with noise
+// that crosses it on every other sample
+static const Sample EDGE_RIGHT[] = {
+  {1900, 1960, 0}, {2162, 1958, 0}, {2141, 1962, 0}, {2170, 1961, 0}, {2138, 1957, 0},
+  {2158, 1963, 0}, {2129, 1960, 0}, {2165, 1959, 0}, {2133, 1961, 0}, {2151, 1960, 0},
+  {2090, 1962, 0}, {1950, 1960, 0},
+};
+
+// diagonal up-left: vertical wins, then horizontal once y is released
+static const Sample DIAGONAL[] = {
+  {1900, 1960, 0}, {1400, 2500, 0}, {900, 3300, 0}, {400, 3900, 0}, {420, 2600, 0},
+  {410, 1980, 0}, {1890, 1955, 0},
+};
+
+// button press with contact bounce on both edges
+static const Sample BUTTON[] = {
+  {1900, 1960, 0}, {1900, 1960, 1}, {1900, 1960, 0}, {1900, 1960, 1}, {1900, 1960, 1},
+  {1900, 1960, 1}, {1900, 1960, 1}, {1900, 1960, 0}, {1900, 1960, 1}, {1900, 1960, 0},
+  {1900, 1960, 0}, {1900, 1960, 0},
+};
+
+static void test_rest_noise_stays_center() {
+  Events e = REPLAY(filter, REST);
+  TEST_ASSERT_EQUAL_INT(0, e.n);
+  TEST_ASSERT_EQUAL_INT8(0, filter.state().dir);
+}
+
+static void test_push_up_one_event_each_way() {
+  Events e = REPLAY(filter, PUSH_UP);
+  TEST_ASSERT_EQUAL_INT(2, e.n);
+  TEST_ASSERT_EQUAL_INT8(1, e.ev[0].dir);
+  TEST_ASSERT_EQUAL_INT8(0, e.ev[1].dir);
+}
+
+static void test_hysteresis_holds_at_edge() {
+  Events e = REPLAY(filter, EDGE_RIGHT);
+  // one entry, one exit, no chatter while the noise straddles the edge
+  TEST_ASSERT_EQUAL_INT(2, e.n);
+  TEST_ASSERT_EQUAL_INT8(2, e.ev[0].dir);
+  TEST_ASSERT_EQUAL_INT8(0, e.ev[1].dir);
+}
+
+static void test_no_hysteresis_chatters_at_edge() {
+  // same trace without hysteresis shows what the band is there for
+  JoystickConfig cfg;
+  cfg.hysteresis = 0;
+  filter.configure(cfg);
+  Events e = REPLAY(filter, EDGE_RIGHT);
+  TEST_ASSERT_GREATER_THAN(2, e.n);
+}
+
+static void test_vertical_wins_on_diagonal() {
+  Events e = REPLAY(filter, DIAGONAL);
+  TEST_ASSERT_EQUAL_INT(3, e.n);
+  TEST_ASSERT_EQUAL_INT8(1, e.ev[0].dir);
+  TEST_ASSERT_EQUAL_INT8(-2, e.ev[1].dir);
+  TEST_ASSERT_EQUAL_INT8(0, e.ev[2].dir);
+}
+
+static void test_button_bounce_debounced() {
+  Events e = REPLAY(filter, BUTTON);
+  TEST_ASSERT_EQUAL_INT(2, e.n);
+  TEST_ASSERT_EQUAL_UINT8(1, e.ev[0].button);
+  TEST_ASSERT_EQUAL_UINT8(0, e.ev[1].button);
+}
+
+static void test_calibrate_accepts_small_offset() {
+  JoystickConfig cfg;
+  TEST_ASSERT_TRUE(JoystickFilter::calibrate(cfg, 1984, 1890));
+  TEST_ASSERT_EQUAL_UINT16(1984, cfg.center_x);
+  TEST_ASSERT_EQUAL_UINT16(1890, cfg.center_y);
+}
+
+static void test_calibrate_rejects_held_stick() {
+  // stick held up during boot: y keeps its default, x still calibrates
+  JoystickConfig cfg;
+  TEST_ASSERT_FALSE(JoystickFilter::calibrate(cfg, 1930, 3650));
+  TEST_ASSERT_EQUAL_UINT16(1930, cfg.center_x);
+  TEST_ASSERT_EQUAL_UINT16(1960, cfg.center_y);
+
+  // so rest still reads as center afterwards
+  filter.configure(cfg);
+  Events e = REPLAY(filter, REST);
+  TEST_ASSERT_EQUAL_INT(0, e.n);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_rest_noise_stays_center);
+  RUN_TEST(test_push_up_one_event_each_way);
+  RUN_TEST(test_hysteresis_holds_at_edge);
+  RUN_TEST(test_no_hysteresis_chatters_at_edge);
+  RUN_TEST(test_vertical_wins_on_diagonal);
+  RUN_TEST(test_button_bounce_debounced);
+  RUN_TEST(test_calibrate_accepts_small_offset);
+  RUN_TEST(test_calibrate_rejects_held_stick);
+  return UNITY_END();
+}
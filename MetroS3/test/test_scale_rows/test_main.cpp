@@ -0,0 +1,115 @@
+// checks the band blitter's row kernels against a plain reference and
+// times the camera upscale:
+//   pio test -e native -f test_scale_rows
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+
+#include "scale_rows.h"
+
+static const int32_t MAX_W = 320;
+
+// source pixel value == its column, so every output names what it sampled
+static uint16_t src_row[MAX_W];
+static uint16_t out_row[MAX_W];
+
+void setUp() {
+  for (int32_t i = 0; i < MAX_W; i++) src_row[i] = (uint16_t)i;
+}
+
+void tearDown() {}
+
+// pixels off the floor(x * src / dst) mapping
+static int32_t nearest_errors(int32_t src_w, int32_t dst_w) {
+  scale_row_nearest(out_row, src_row, src_w, dst_w);
+  int32_t bad = 0;
+  for (int32_t x = 0; x < dst_w; x++) {
+    if (out_row[x] != x * src_w / dst_w) bad++;
+  }
+  return bad;
+}
+
+static void test_nearest_fractional_sizes() {
+  TEST_ASSERT_EQUAL_INT(0, nearest_errors(160, 240));   // QQVGA -> 240x180
+  TEST_ASSERT_EQUAL_INT(0, nearest_errors(320, 240));   // QVGA downscale
+  TEST_ASSERT_EQUAL_INT(0, nearest_errors(120, 180));
+  TEST_ASSERT_EQUAL_INT(0, nearest_errors(240, 320));
+}
+
+static void test_nearest_every_size_pair() {
+  // 16.16 steps drift off the reference once dst passes 256
+  for (int32_t s = 1; s <= MAX_W; s++) {
+    for (int32_t d = 1; d <= MAX_W; d++) {
+      if (nearest_errors(s, d)) {
+        char msg[48];
+        snprintf(msg, sizeof(msg), "src %d dst %d", (int)s, (int)d);
+        TEST_FAIL_MESSAGE(msg);
+      }
+    }
+  }
+}
+
+static void test_row_stepper_matches_reference() {
+  // rows use the same stepper, 240x180 over 160x120 is the reported case
+  NearestStep sy(120, 180);
+  for (int32_t y = 0; y < 180; y++, sy.next()) {
+    TEST_ASSERT_EQUAL_INT(y * 120 / 180, sy.pos);
+  }
+}
+
+static void test_int_zoom_repeats_pixels() {
+  for (int32_t zx = 1; zx <= 3; zx++) {
+    scale_row_int(out_row, src_row, 80, zx);
+    for (int32_t x = 0; x < 80 * zx; x++) TEST_ASSERT_EQUAL_UINT16(x / zx, out_row[x]);
+  }
+}
+
+// one frame the way the blitter builds it, repeated rows copied
+static void scale_frame(uint16_t *dst, const uint16_t *src, int32_t src_w, int32_t src_h,
+                        int32_t dst_w, int32_t dst_h, bool int_zoom) {
+  NearestStep sy(src_h, dst_h);
+  int32_t last_sy = -1;
+  for (int32_t r = 0; r < dst_h; r++, sy.next()) {
+    uint16_t *out = dst + r * dst_w;
+    if (sy.pos == last_sy) {
+      memcpy(out, out - dst_w, dst_w * sizeof(uint16_t));
+    } else if (int_zoom) {
+      scale_row_int(out, src + sy.pos * src_w, src_w, dst_w / src_w);
+    } else {
+      scale_row_nearest(out, src + sy.pos * src_w, src_w, dst_w);
+    }
+    last_sy = sy.pos;
+  }
+}
+
+// the camera case: 160x120 QQVGA onto the 320x240 panel
+static void test_bench_160x120_to_320x240() {
+  static uint16_t src[160 * 120];
+  static uint16_t a[320 * 240], b[320 * 240];
+  for (int32_t i = 0; i < 160 * 120; i++) src[i] = (uint16_t)(i * 2654435761u >> 16);
+
+  const int frames = 200;
+  double us[2];
+  for (int k = 0; k < 2; k++) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; f++) scale_frame(k ? b : a, src, 160, 120, 320, 240, k == 0);
+    auto t1 = std::chrono::steady_clock::now();
+    us[k] = std::chrono::duration<double, std::micro>(t1 - t0).count() / frames;
+  }
+  TEST_ASSERT_EQUAL_MEMORY(a, b, sizeof(a));
+
+  char msg[80];
+  snprintf(msg, sizeof(msg), "per frame: int zoom %.1f us, nearest %.1f us", us[0], us[1]);
+  TEST_MESSAGE(msg);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_nearest_fractional_sizes);
+  RUN_TEST(test_nearest_every_size_pair);
+  RUN_TEST(test_row_stepper_matches_reference);
+  RUN_TEST(test_int_zoom_repeats_pixels);
+  RUN_TEST(test_bench_160x120_to_320x240);
+  return UNITY_END();
+}
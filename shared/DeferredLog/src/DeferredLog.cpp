@@ -0,0 +1,205 @@
+#include "DeferredLog.h"
+
+#include <new>
+#include <string.h>
+
+namespace dlog {
+
+// ===== binary framing =====
+// every frame: SYNC | type | len | payload[len]   (little endian fields)
+//   'D' describe: id | format bytes
+//   'R' record:   id | ms u32 | suppressed u16 | args u32 * n
+static const uint8_t FRAME_SYNC = 0xA5;
+static const uint8_t FRAME_DESCRIBE = 'D';
+static const uint8_t FRAME_RECORD = 'R';
+static const uint8_t MAX_SITES = 64;
+static const uint32_t REDESCRIBE_MS = 10000;   // so a late-attached decoder catches up
+
+struct Record {
+  uint32_t ms;
+  Site *site;
+  uint16_t suppressed;
+  uint8_t nargs;
+  uint32_t args[DLOG_MAX_ARGS];
+};
+
+// bounded multi-producer / single-consumer ring. each cell carries a
+// sequence number so producers claim slots with one CAS and the drain
+// task can tell a filled slot from one still being written
+struct Cell {
+  std::atomic<uint32_t> seq;
+  Record rec;
+};
+
+static Cell *ring = nullptr;
+static uint32_t mask = 0;
+static std::atomic<uint32_t> head{0};
+static uint32_t tail = 0;   // drain task only
+
+static std::atomic<uint32_t> written{0};
+static std::atomic<uint32_t> dropped{0};
+static std::atomic<uint32_t> rateLimited{0};
+static std::atomic<uint8_t> nextId{0};
+
+static Print *out = nullptr;
+static bool binaryMode = false;
+static Site *sites[MAX_SITES + 1];            // by id, drain task only
+static uint32_t describedMs[MAX_SITES + 1];
+
+static bool push(const Record &r) {
+  uint32_t pos = head.load(std::memory_order_relaxed);
+  for (;;) {
+    Cell &c = ring[pos & mask];
+    int32_t diff = (int32_t)(c.seq.load(std::memory_order_acquire) - pos);
+    if (diff == 0) {
+      if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        c.rec = r;
+        c.seq.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (diff < 0) {
+      return false;   // full
+    } else {
+      pos = head.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+static bool pop(Record &r) {
+  Cell &c = ring[tail & mask];
+  if (c.seq.load(std::memory_order_acquire) != tail + 1) return false;
+  r = c.rec;
+  c.seq.store(tail + mask + 1, std::memory_order_release);
+  tail++;
+  return true;
+}
+
+// ===== output =====
+
+static void writeFrame(uint8_t type, const uint8_t *payload, uint8_t len) {
+  uint8_t hdr[3] = {FRAME_SYNC, type, len};
+  out->write(hdr, sizeof(hdr));
+  out->write(payload, len);
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+  p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+static void emitBinary(const Record &r) {
+  uint8_t id = r.site->id.load(std::memory_order_relaxed);
+  if (id == 0 || id > MAX_SITES) return;
+
+  // the format string goes out once per site (and again now and then)
+  if (sites[id] != r.site || (uint32_t)(r.ms - describedMs[id]) >= REDESCRIBE_MS) {
+    uint8_t buf[255];
+    size_t n = strnlen(r.site->fmt, sizeof(buf) - 1);
+    buf[0] = id;
+    memcpy(buf + 1, r.site->fmt, n);
+    writeFrame(FRAME_DESCRIBE, buf, n + 1);
+    sites[id] = r.site;
+    describedMs[id] = r.ms;
+  }
+
+  uint8_t buf[1 + 4 + 2 + 4 * DLOG_MAX_ARGS];
+  buf[0] = id;
+  put32(buf + 1, r.ms);
+  buf[5] = r.suppressed;
+  buf[6] = r.suppressed >> 8;
+  for (uint8_t i = 0; i < r.nargs; i++) put32(buf + 7 + 4 * i, r.args[i]);
+  writeFrame(FRAME_RECORD, buf, 7 + 4 * r.nargs);
+}
+
+static void emitText(const Record &r) {
+  static_assert(DLOG_MAX_ARGS == 8, "pass every arg slot to snprintf below");
+  char line[160];
+  const uint32_t *a = r.args;
+  // unused trailing args are ignored by snprintf
+  int n = snprintf(line, sizeof(line), r.site->fmt, a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7]);
+  if (n < 0) return;
+  if (n >= (int)sizeof(line)) n = sizeof(line) - 1;
+  if (n > 0 && line[n - 1] == '\n') n--;   // one newline per record, added below
+  out->write((const uint8_t *)line, n);
+  if (r.suppressed) out->printf(" [+%u suppressed]", (unsigned)r.suppressed);
+  out->write('\n');
+}
+
+static void drainTask(void *arg) {
+  Record r;
+  for (;;) {
+    while (pop(r)) {
+      if (binaryMode) {
+        emitBinary(r);
+      } else {
+        emitText(r);
+      }
+      written.fetch_add(1, std::memory_order_relaxed);
+    }
+    vTaskDelay(pdMS_TO_TICKS(10));
+  }
+}
+
+// ===== API =====
+
+bool begin(Print &o, bool binary, size_t depth, UBaseType_t priority) {
+  if (ring) return false;
+
+  uint32_t n = 1;
+  while (n < depth) n <<= 1;
+  ring = new (std::nothrow) Cell[n];
+  if (!ring) return false;
+  for (uint32_t i = 0; i < n; i++) ring[i].seq.store(i, std::memory_order_relaxed);
+  mask = n - 1;
+
+  out = &o;
+  binaryMode = binary;
+  return xTaskCreate(drainTask, "dlog", 3072, nullptr, priority, nullptr) == pdPASS;
+}
+
+bool post(Site &site, const uint32_t *args, uint8_t nargs) {
+  if (!ring) return false;
+
+  uint32_t now = millis();
+  if (site.rate_ms) {
+    uint32_t last = site.last_ms.load(std::memory_order_relaxed);
+    // last == 0: this site never logged yet
+    if (last != 0 && (now - last) < site.rate_ms) {
+      site.suppressed.fetch_add(1, std::memory_order_relaxed);
+      rateLimited.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    // another producer won this slot
+    if (!site.last_ms.compare_exchange_strong(last, now ? now : 1, std::memory_order_relaxed)) {
+      site.suppressed.fetch_add(1, std::memory_order_relaxed);
+      rateLimited.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+  }
+
+  if (site.id.load(std::memory_order_relaxed) == 0) {
+    uint8_t id = nextId.fetch_add(1, std::memory_order_relaxed) + 1;
+    uint8_t expected = 0;
+    site.id.compare_exchange_strong(expected, id, std::memory_order_relaxed);
+  }
+
+  Record r;
+  r.ms = now;
+  r.site = &site;
+  r.suppressed = site.suppressed.exchange(0, std::memory_order_relaxed);
+  r.nargs = nargs;
+  for (uint8_t i = 0; i < DLOG_MAX_ARGS; i++) r.args[i] = (i < nargs) ? args[i] : 0;
+
+  if (!push(r)) {
+    // hand the count back so the next record that fits still reports it
+    if (r.suppressed) site.suppressed.fetch_add(r.suppressed, std::memory_order_relaxed);
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+Stats stats() {
+  return {written.load(), dropped.load(), rateLimited.load()};
+}
+
+}  // namespace dlog
@@ -0,0 +1,75 @@
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+// Non-blocking logging shared by both firmwares.
+//
+// DLOG()/DLOG_EVERY() copy the format pointer and up to DLOG_MAX_ARGS
+// integer arguments into a lock-free ring and return. A low-priority
+// drain task formats them onto Serial, so hot paths (radio callbacks,
+// per-frame code) never wait on the UART.
+//
+// Formats must be string literals and may only use 32-bit integer
+// conversions (%d %u %x %X %c with flags/width), no %s or floats.
+//
+// In binary mode each record goes out as a small frame instead of text;
+// tools/dlog_decode.py turns the stream back into lines on the host.
+
+#include <Arduino.h>
+#include <atomic>
+#include <type_traits>
+
+#define DLOG_MAX_ARGS 8
+
+namespace dlog {
+
+// one per call site, created by the macros below
+struct Site {
+  constexpr Site(const char *f, uint16_t rate) : fmt(f), rate_ms(rate) {}
+
+  const char *fmt;
+  uint16_t rate_ms;                      // 0 = no limit
+  std::atomic<uint8_t> id{0};            // assigned on first use, for binary mode
+  std::atomic<uint32_t> last_ms{0};
+  std::atomic<uint16_t> suppressed{0};   // dropped by the rate limit since last emit
+};
+
+struct Stats {
+  uint32_t written;
+  uint32_t dropped;        // ring was full
+  uint32_t rate_limited;
+};
+
+// starts the drain task. depth is rounded up to a power of two
+bool begin(Print &out, bool binary = false, size_t depth = 64, UBaseType_t priority = tskIDLE_PRIORITY);
+
+// true when the record was queued
+bool post(Site &site, const uint32_t *args, uint8_t nargs);
+
+Stats stats();
+
+template <typename T>
+inline uint32_t toArg(T v) {
+  static_assert(std::is_integral<T>::value || std::is_enum<T>::value,
+                "DLOG takes integer arguments only");
+  return (uint32_t)v;
+}
+
+template <typename... A>
+inline bool log(Site &site, A... args) {
+  static_assert(sizeof...(A) <= DLOG_MAX_ARGS, "too many DLOG arguments");
+  const uint32_t v[sizeof...(A) + 1] = {toArg(args)..., 0};
+  return post(site, v, sizeof...(A));
+}
+
+}  // namespace dlog
+
+// at most one record per ms milliseconds from this call site
+#define DLOG_EVERY(ms, fmt, ...)                              \
+  do {                                                        \
+    static dlog::Site _dlog_site((fmt), (ms));                \
+    dlog::log(_dlog_site, ##__VA_ARGS__);                     \
+  } while (0)
+
+#define DLOG(fmt, ...) DLOG_EVERY(0, fmt, ##__VA_ARGS__)
+
+#endif
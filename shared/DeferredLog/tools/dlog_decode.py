@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+"""Decode DeferredLog binary output back into text lines.
+
+Reads a captured serial stream (file or stdin), or a live port with
+--port (needs pyserial). Plain text printed by other code passes through
+unchanged; binary frames start with 0xA5, which never occurs in ASCII.
+
+  frame:   0xA5 | type | len | payload[len]
+  'D':     id | format string
+  'R':     id | ms u32 | suppressed u16 | args u32 * n   (little endian)
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+SYNC = 0xA5
+CONV = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(?:hh|h|ll|l|z|j|t)?([diouxXc%])")
+
+
+def c_format(fmt, args):
+    """printf-style formatting limited to what the firmware allows."""
+    it = iter(args)
+
+    def repl(m):
+        flags, conv = m.group(1), m.group(2)
+        if conv == "%":
+            return "%"
+        v = next(it, 0)
+        if conv in "di" and v >= 0x80000000:
+            v -= 0x100000000
+        if conv == "u":
+            conv = "d"
+        return ("%" + flags + conv) % v
+
+    return CONV.sub(repl, fmt)
+
+
+class Decoder:
+    def __init__(self, out):
+        self.out = out
+        self.formats = {}
+        self.buf = bytearray()
+        self.text = bytearray()
+
+    def flush_text(self):
+        if self.text:
+            self.out.write(self.text.decode("ascii", "replace"))
+            self.text.clear()
+
+    def feed(self, data):
+        self.buf += data
+        while self.buf:
+            if self.buf[0] != SYNC:
+                i = self.buf.find(SYNC)
+                end = len(self.buf) if i < 0 else i
+                self.text += self.buf[:end]
+                del self.buf[:end]
+                continue
+            if len(self.buf) < 3 or len(self.buf) < 3 + self.buf[2]:
+                return   # wait for the rest of the frame
+            ftype, n = self.buf[1], self.buf[2]
+            payload = bytes(self.buf[3:3 + n])
+            del self.buf[:3 + n]
+            self.flush_text()
+            self.frame(ftype, payload)
+        self.flush_text()
+
+    def frame(self, ftype, p):
+        if ftype == ord("D") and p:
+            self.formats[p[0]] = p[1:].decode("ascii", "replace")
+        elif ftype == ord("R") and len(p) >= 7:
+            site, ms, supp = p[0], struct.unpack_from("<I", p, 1)[0], struct.unpack_from("<H", p, 5)[0]
+            args = struct.unpack_from("<%dI" % ((len(p) - 7) // 4), p, 7)
+            fmt = self.formats.get(site)
+            if fmt is None:
+                line = "<site %d not described yet> %s" % (site, " ".join("%08X" % a for a in args))
+            else:
+                line = c_format(fmt, args).rstrip("\n")
+            if supp:
+                line += " [+%d suppressed]" % supp
+            self.out.write("%10.3f %s\n" % (ms / 1000.0, line))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("file", nargs="?", help="captured stream, stdin if omitted")
+    ap.add_argument("--port", help="read a serial port instead")
+    ap.add_argument("--baud", type=int, default=115200)
+    a = ap.parse_args()
+
+    dec = Decoder(sys.stdout)
+    if a.port:
+        import serial  # pyserial
+        with serial.Serial(a.port, a.baud, timeout=0.1) as s:
+            while True:
+                dec.feed(s.read(256))
+                sys.stdout.flush()
+    else:
+        src = open(a.file, "rb") if a.file else sys.stdin.buffer
+        with src:
+            while True:
+                chunk = src.read(4096)
+                if not chunk:
+                    break
+                dec.feed(chunk)
+
+
+if __name__ == "__main__":
+    main()